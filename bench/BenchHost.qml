@@ -0,0 +1,43 @@
+import QtQuick
+import "../qml"
+
+// Hosts the view under test at a fixed size; the C++ driver plays the part of
+// ChatBridge and calls the same functions Main.qml wires to its signals.
+Item {
+    id: host
+    width: 600
+    height: 900
+    property string view: "insights"
+    property var streamingDocument: null
+    readonly property var panel: loader.item
+
+    Loader {
+        id: loader
+        anchors.fill: parent
+        sourceComponent: host.view === "chat" ? chatComponent : insightsComponent
+    }
+
+    Component {
+        id: insightsComponent
+        InsightsPanel {
+            streamingDocument: host.streamingDocument
+        }
+    }
+
+    // Bare ChatView with the same entry points InsightsPanel exposes
+    Component {
+        id: chatComponent
+        ChatView {
+            streamingDocument: host.streamingDocument
+            function setChatMessages(m) { messages = m }
+            function updateLastMessage() {
+                isStreaming = true
+                streamingTick++
+            }
+            function finishStreaming(m) {
+                isStreaming = false
+                messages = m
+            }
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "framerecorder.h"
+#include <QQuickWindow>
+#include <QMutexLocker>
+#include <algorithm>
+
+FrameRecorder::FrameRecorder(QQuickWindow* window, QObject* parent) : QObject(parent) {
+    m_clock.start();
+    auto now = [this]() { return m_clock.nsecsElapsed(); };
+    auto ms = [](qint64 ns) { return ns / 1e6; };
+
+    connect(window, &QQuickWindow::beforeSynchronizing, this, [this, now]() {
+        QMutexLocker lock(&m_mutex);
+        m_syncStart = now();
+    }, Qt::DirectConnection);
+    connect(window, &QQuickWindow::afterSynchronizing, this, [this, now, ms]() {
+        QMutexLocker lock(&m_mutex);
+        if (m_running && m_syncStart >= 0) m_syncMs << ms(now() - m_syncStart);
+        m_syncStart = -1;
+    }, Qt::DirectConnection);
+    connect(window, &QQuickWindow::beforeRendering, this, [this, now]() {
+        QMutexLocker lock(&m_mutex);
+        m_renderStart = now();
+    }, Qt::DirectConnection);
+    connect(window, &QQuickWindow::afterRendering, this, [this, now, ms]() {
+        QMutexLocker lock(&m_mutex);
+        if (m_running && m_renderStart >= 0) m_renderMs << ms(now() - m_renderStart);
+        m_renderStart = -1;
+    }, Qt::DirectConnection);
+    connect(window, &QQuickWindow::frameSwapped, this, [this, now, ms]() {
+        QMutexLocker lock(&m_mutex);
+        const qint64 t = now();
+        if (m_running && m_lastSwap >= 0) m_frameMs << ms(t - m_lastSwap);
+        m_lastSwap = t;
+    }, Qt::DirectConnection);
+}
+
+void FrameRecorder::start() {
+    QMutexLocker lock(&m_mutex);
+    m_syncMs.clear();
+    m_renderMs.clear();
+    m_frameMs.clear();
+    m_lastSwap = -1;
+    m_running = true;
+}
+
+void FrameRecorder::stop() {
+    QMutexLocker lock(&m_mutex);
+    m_running = false;
+}
+
+QVariantMap FrameRecorder::percentiles(QVector<double> samples) {
+    if (samples.isEmpty()) return {{"count", 0}};
+    std::sort(samples.begin(), samples.end());
+    auto at = [&samples](double p) {
+        const int i = qBound(0, int(p * (samples.size() - 1) + 0.5), int(samples.size()) - 1);
+        return samples.at(i);
+    };
+    double sum = 0;
+    for (double s : samples) sum += s;
+    return {
+        {"count", int(samples.size())},
+        {"mean", sum / samples.size()},
+        {"p50", at(0.50)},
+        {"p90", at(0.90)},
+        {"p99", at(0.99)},
+        {"max", samples.last()}
+    };
+}
+
+QVariantMap FrameRecorder::report(double targetFrameMs) const {
+    QMutexLocker lock(&m_mutex);
+    int dropped = 0;
+    for (double f : m_frameMs) {
+        if (f > targetFrameMs * 1.5) dropped += qMax(1, int(f / targetFrameMs) - 1);
+    }
+    return {
+        {"frame", percentiles(m_frameMs)},
+        {"sync", percentiles(m_syncMs)},
+        {"render", percentiles(m_renderMs)},
+        {"droppedFrames", dropped}
+    };
+}
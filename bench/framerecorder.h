@@ -0,0 +1,38 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+#include <QVariantMap>
+
+class QQuickWindow;
+
+// Per-frame timings from QQuickWindow's scene graph signals: sync time
+// (before/afterSynchronizing), render time (before/afterRendering) and the
+// interval between swapped frames. Connected directly, since with the
+// threaded render loop the signals arrive on the render thread.
+class FrameRecorder : public QObject {
+    Q_OBJECT
+public:
+    explicit FrameRecorder(QQuickWindow* window, QObject* parent=nullptr);
+
+    void start();
+    void stop();
+
+    // Percentiles of all series, in milliseconds; frames slower than
+    // 1.5x the target interval count as dropped
+    QVariantMap report(double targetFrameMs = 1000.0 / 60.0) const;
+
+    static QVariantMap percentiles(QVector<double> samples);
+
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    bool m_running{false};
+    qint64 m_syncStart{-1};
+    qint64 m_renderStart{-1};
+    qint64 m_lastSwap{-1};
+    QVector<double> m_syncMs;
+    QVector<double> m_renderMs;
+    QVector<double> m_frameMs;
+};
@@ -0,0 +1,102 @@
+#include "syntheticchatbridge.h"
+#include <QMetaObject>
+#include <QVariantMap>
+
+namespace {
+// Shaped like a typical answer: paragraphs, a list, a table-free code block
+const char* kAnswer =
+    "## Market overview\n\n"
+    "The **global smartphone market** shipped roughly 1.2 billion units in 2023, "
+    "a decline of about 3% year over year according to [Statista](https://www.statista.com/statistics/263437/).\n\n"
+    "- Apple held *20%* of shipments\n"
+    "- Samsung followed with 19%\n"
+    "- Xiaomi, Oppo and Transsion made up most of the rest\n\n"
+    "> Replacement cycles have lengthened to over 40 months in mature markets.\n\n"
+    "```\nyear  units(bn)\n2021  1.35\n2022  1.21\n2023  1.17\n```\n\n"
+    "1. Premium devices kept growing\n"
+    "2. Entry-level demand fell sharply\n\n";
+}
+
+SyntheticChatBridge::SyntheticChatBridge(QObject* view, const Script& script, QObject* parent)
+    : QObject(parent), m_view(view), m_script(script), m_tokens(scriptedTokens()) {
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(qMax(1, 1000 / qMax(1, m_script.tokensPerSecond)));
+    connect(&m_timer, &QTimer::timeout, this, &SyntheticChatBridge::tick);
+}
+
+QStringList SyntheticChatBridge::scriptedTokens() {
+    // Claude's text deltas are a few characters each
+    const QString text = QString::fromUtf8(kAnswer);
+    QStringList tokens;
+    for (int i = 0; i < text.size();) {
+        const int len = 2 + (i * 7) % 5;
+        tokens << text.mid(i, len);
+        i += len;
+    }
+    return tokens;
+}
+
+double SyntheticChatBridge::invokeTimed(const char* method, const QVariant& arg) {
+    QElapsedTimer t;
+    t.start();
+    if (arg.isValid()) QMetaObject::invokeMethod(m_view, method, Q_ARG(QVariant, arg));
+    else QMetaObject::invokeMethod(m_view, method);
+    return t.nsecsElapsed() / 1e6;
+}
+
+void SyntheticChatBridge::seedHistory() {
+    QString answer;
+    for (const QString& t : m_tokens) answer += t;
+    const QString html = MarkdownRenderer::toHtml(answer);
+    for (int i = 0; i < m_script.historyLength; ++i) {
+        QVariantMap m;
+        if (i % 2 == 0) {
+            m["role"] = "user";
+            m["content"] = QString("Question %1 about market statistics").arg(i / 2 + 1);
+        } else {
+            m["role"] = "assistant";
+            m["content"] = answer;
+            m["html"] = html;
+            m["model"] = "synthetic";
+        }
+        m_messages << m;
+    }
+    m_setMessagesMs << invokeTimed("setChatMessages", m_messages);
+}
+
+void SyntheticChatBridge::startStreaming() {
+    m_messages << QVariantMap{{"role", "user"}, {"content", "How big is the smartphone market?"}};
+    m_setMessagesMs << invokeTimed("setChatMessages", m_messages);
+    m_messages << QVariantMap{{"role", "assistant"}, {"content", ""}, {"model", "synthetic"}};
+    m_doc.reset();
+    m_setMessagesMs << invokeTimed("setChatMessages", m_messages);
+
+    m_emitted = 0;
+    m_clock.start();
+    m_timer.start();
+}
+
+void SyntheticChatBridge::tick() {
+    // Catch up on every token due by now, so high rates survive timer granularity
+    const int due = qMin(m_script.tokenCount, int(m_clock.elapsed() * m_script.tokensPerSecond / 1000));
+    if (m_emitted >= due) return;
+
+    QVariantMap last = m_messages.last().toMap();
+    QString content = last.value("content").toString();
+    for (; m_emitted < due; ++m_emitted) {
+        const QString& token = m_tokens.at(m_emitted % m_tokens.size());
+        content += token;
+        m_doc.append(token);
+        last["content"] = content;
+        m_messages.last() = last;
+        m_updateLastMs << invokeTimed("updateLastMessage");
+    }
+
+    if (m_emitted >= m_script.tokenCount) {
+        m_timer.stop();
+        last["html"] = MarkdownRenderer::toHtml(content);
+        m_messages.last() = last;
+        m_finishMs = invokeTimed("finishStreaming", m_messages);
+        emit finished();
+    }
+}
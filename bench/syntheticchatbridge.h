@@ -0,0 +1,52 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantList>
+#include <QVector>
+#include "markdownrenderer.h"
+
+// Stands in for ChatBridge: seeds a history of the given length, then streams
+// a scripted assistant answer at a fixed token rate, driving the view through
+// the same calls Main.qml makes (setChatMessages, updateLastMessage,
+// finishStreaming) and timing each of them.
+class SyntheticChatBridge : public QObject {
+    Q_OBJECT
+public:
+    struct Script {
+        int tokensPerSecond{60};
+        int historyLength{50};
+        int tokenCount{1500};
+    };
+
+    SyntheticChatBridge(QObject* view, const Script& script, QObject* parent=nullptr);
+
+    MarkdownDocument* streamingDocument() { return &m_doc; }
+    void seedHistory();
+    void startStreaming();
+
+    QVector<double> setMessagesMs() const { return m_setMessagesMs; }
+    QVector<double> updateLastMs() const { return m_updateLastMs; }
+    double finishMs() const { return m_finishMs; }
+
+signals:
+    void finished();
+
+private:
+    void tick();
+    double invokeTimed(const char* method, const QVariant& arg = QVariant());
+    static QStringList scriptedTokens();
+
+    QObject* m_view;
+    Script m_script;
+    QVariantList m_messages;
+    MarkdownDocument m_doc;
+    QStringList m_tokens;
+    int m_emitted{0};
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+
+    QVector<double> m_setMessagesMs;
+    QVector<double> m_updateLastMs;
+    double m_finishMs{0};
+};
@@ -0,0 +1,109 @@
+// Streams a scripted answer into ChatView/InsightsPanel offscreen and reports
+// frame, sync and render time percentiles plus the cost of the view updates.
+//
+//   ui_stream_bench --rate 120 --history 200 --tokens 2000 --view insights --json
+
+#include <QGuiApplication>
+#include <QQuickView>
+#include <QQmlEngine>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QUrl>
+#include <cstdio>
+#include "framerecorder.h"
+#include "syntheticchatbridge.h"
+
+namespace {
+void printSeries(const char* name, const QVariantMap& p) {
+    if (p.value("count").toInt() == 0) {
+        std::printf("%-18s   (no samples)\n", name);
+        return;
+    }
+    std::printf("%-18s n=%-6d p50=%7.2f  p90=%7.2f  p99=%7.2f  max=%7.2f ms\n", name,
+                p.value("count").toInt(), p.value("p50").toDouble(), p.value("p90").toDouble(),
+                p.value("p99").toDouble(), p.value("max").toDouble());
+}
+}
+
+int main(int argc, char* argv[]) {
+    // Offscreen unless told otherwise, so the bench runs headless and in CI
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Streaming UI benchmark for ChatView.qml and InsightsPanel.qml");
+    parser.addHelpOption();
+    QCommandLineOption rateOpt("rate", "Tokens per second.", "n", "60");
+    QCommandLineOption historyOpt("history", "Messages already in the conversation.", "n", "50");
+    QCommandLineOption tokensOpt("tokens", "Tokens to stream.", "n", "1500");
+    QCommandLineOption viewOpt("view", "View under test: insights or chat.", "name", "insights");
+    QCommandLineOption jsonOpt("json", "Print the report as JSON.");
+    parser.addOptions({rateOpt, historyOpt, tokensOpt, viewOpt, jsonOpt});
+    parser.process(app);
+
+    SyntheticChatBridge::Script script;
+    script.tokensPerSecond = qMax(1, parser.value(rateOpt).toInt());
+    script.historyLength = qMax(0, parser.value(historyOpt).toInt());
+    script.tokenCount = qMax(1, parser.value(tokensOpt).toInt());
+
+    QQuickView window;
+    window.setResizeMode(QQuickView::SizeRootObjectToView);
+    window.setInitialProperties({{"view", parser.value(viewOpt)}});
+    window.setSource(QUrl::fromLocalFile(QStringLiteral(BENCH_QML_DIR "/BenchHost.qml")));
+    if (window.status() != QQuickView::Ready || !window.rootObject()) {
+        for (const auto& e : window.errors()) std::fprintf(stderr, "%s\n", qPrintable(e.toString()));
+        return 1;
+    }
+    window.resize(600, 900);
+    window.show();
+
+    QObject* panel = window.rootObject()->property("panel").value<QObject*>();
+    if (!panel) {
+        std::fprintf(stderr, "View under test failed to load\n");
+        return 1;
+    }
+
+    FrameRecorder frames(&window);
+    SyntheticChatBridge bridge(panel, script);
+    window.rootObject()->setProperty("streamingDocument", QVariant::fromValue<QObject*>(bridge.streamingDocument()));
+
+    QObject::connect(&bridge, &SyntheticChatBridge::finished, &app, [&]() {
+        // Let the final layout reach the screen before stopping the clock
+        QTimer::singleShot(250, &app, [&]() {
+            frames.stop();
+            QVariantMap report = frames.report();
+            report["setChatMessages"] = FrameRecorder::percentiles(bridge.setMessagesMs());
+            report["updateLastMessage"] = FrameRecorder::percentiles(bridge.updateLastMs());
+            report["finishStreamingMs"] = bridge.finishMs();
+            report["script"] = QVariantMap{
+                {"view", parser.value(viewOpt)},
+                {"tokensPerSecond", script.tokensPerSecond},
+                {"history", script.historyLength},
+                {"tokens", script.tokenCount}
+            };
+
+            if (parser.isSet(jsonOpt)) {
+                std::printf("%s\n", QJsonDocument(QJsonObject::fromVariantMap(report)).toJson().constData());
+            } else {
+                std::printf("view=%s rate=%d tok/s history=%d tokens=%d\n", qPrintable(parser.value(viewOpt)),
+                            script.tokensPerSecond, script.historyLength, script.tokenCount);
+                printSeries("frame interval", report.value("frame").toMap());
+                printSeries("sync", report.value("sync").toMap());
+                printSeries("render", report.value("render").toMap());
+                printSeries("setChatMessages", report.value("setChatMessages").toMap());
+                printSeries("updateLastMessage", report.value("updateLastMessage").toMap());
+                std::printf("%-18s %.2f ms\n", "finishStreaming", report.value("finishStreamingMs").toDouble());
+                std::printf("%-18s %d\n", "dropped frames", report.value("droppedFrames").toInt());
+            }
+            app.quit();
+        });
+    });
+
+    // History layout is part of the cost being measured, so record from here on
+    frames.start();
+    bridge.seedHistory();
+    QTimer::singleShot(0, &bridge, &SyntheticChatBridge::startStreaming);
+    return app.exec();
+}
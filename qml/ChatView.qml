@@ -8,23 +8,30 @@ Item {
     property var messages: [] // [{role:"user"|"assistant", content:string}]
     property string errorText: ""
     property var followups: [] // [{query}]
-    property string streamingContent: "" // Content being streamed for the last message
+    property var streamingDocument: null // Finalized + open markdown blocks of the streaming message
+    property int streamingTick: 0 // Bumped on each streamed update
     property bool isStreaming: false
+    property bool hasOlder: false // Older messages are still on disk
     signal send(string text)
     signal openCitation(string url)
     signal runNextFollowup()
+    signal loadOlder()
+
+    // Distance from the bottom to restore once older messages are prepended
+    property real pendingOlderOffset: -1
 
     // Dynamic width calculation
     property real availableWidth: width
 
     // Auto-scroll when streaming content updates
-    onStreamingContentChanged: {
+    onStreamingTickChanged: {
         Qt.callLater(scrollView.scrollToBottom)
     }
 
-    // Auto-scroll when messages change
+    // Auto-scroll when messages change, unless older history was paged in above
     onMessagesChanged: {
-        Qt.callLater(scrollView.scrollToBottom)
+        if (pendingOlderOffset >= 0) Qt.callLater(scrollView.keepOffsetFromBottom)
+        else Qt.callLater(scrollView.scrollToBottom)
     }
 
     Rectangle {
@@ -94,6 +101,24 @@ Item {
                 }
             }
 
+            function keepOffsetFromBottom() {
+                scrollView.contentItem.contentY = Math.max(0, scrollView.contentHeight - root.pendingOlderOffset)
+                root.pendingOlderOffset = -1
+            }
+
+            // Page in older history when scrolled to the top
+            Connections {
+                target: scrollView.contentItem
+                function onContentYChanged() {
+                    if (root.hasOlder && root.pendingOlderOffset < 0
+                            && scrollView.contentHeight > scrollView.height
+                            && scrollView.contentItem.contentY <= 0) {
+                        root.pendingOlderOffset = scrollView.contentHeight
+                        root.loadOlder()
+                    }
+                }
+            }
+
             Column {
                 id: messagesColumn
                 width: parent.width
@@ -105,6 +130,7 @@ Item {
                         width: parent.width
                         height: messageRect.height + 16
                         property var m: messages[index]
+                        property bool streamingThis: root.isStreaming && index === messages.length - 1 && m.role === "assistant"
                         
                         Rectangle {
                             id: messageRect
@@ -156,7 +182,8 @@ Item {
                                     Layout.fillWidth: true
                                     
                                     Text {
-                                        text: m.role === "user" ? "👤 You" : "🤖 Assistant"
+                                        text: m.role === "user" ? "👤 You" : "🤖 Assistant" + (m.model ? " · " + m.model : "")
+                                            + (m.usage && m.usage.tokens > 0 ? " · " + m.usage.tokens + " tokens" : "")
                                         font.pixelSize: 12
                                         font.weight: Font.Medium
                                         color: m.role === "user" ? "#ffffff" : "#64748b"
@@ -173,15 +200,38 @@ Item {
                                     }
                                 }
                                 
+                                // While streaming, each markdown block is its own Text, so only
+                                // the open block at the end is re-laid out per update
+                                Column {
+                                    id: streamingBlocks
+                                    Layout.fillWidth: true
+                                    visible: streamingThis
+                                    spacing: 4
+
+                                    Repeater {
+                                        model: streamingThis ? root.streamingDocument : null
+                                        Text {
+                                            width: streamingBlocks.width
+                                            textFormat: Text.RichText
+                                            text: model.html
+                                            wrapMode: Text.Wrap
+                                            color: "#1e293b"
+                                            font.pixelSize: 14
+                                            font.family: "SF Pro Display, -apple-system, BlinkMacSystemFont, system-ui, sans-serif"
+                                            onLinkActivated: (link) => root.openCitation(link)
+                                        }
+                                    }
+                                }
+
                                 TextArea {
                                     id: messageText
                                     Layout.fillWidth: true
+                                    visible: !streamingThis
                                     readOnly: true
-                                    textFormat: m.role === "assistant" ? TextEdit.MarkdownText : TextEdit.PlainText
-                                    // Use streamingContent for the last assistant message during streaming
-                                    text: (root.isStreaming && index === messages.length - 1 && m.role === "assistant")
-                                          ? root.streamingContent
-                                          : m.content
+                                    // Finished assistant messages carry pre-rendered HTML
+                                    textFormat: m.html ? TextEdit.RichText
+                                                       : (m.role === "assistant" ? TextEdit.MarkdownText : TextEdit.PlainText)
+                                    text: m.html ? m.html : m.content
                                     wrapMode: TextEdit.Wrap
                                     color: m.role === "user" ? "#ffffff" : "#1e293b"
                                     font.pixelSize: 14
@@ -194,14 +244,6 @@ Item {
                                         console.log("Link clicked:", link)
                                         root.openCitation(link)
                                     }
-
-                                    // Custom markdown styling for assistant messages
-                                    onTextChanged: {
-                                        if (m.role === "assistant") {
-                                            // Enable rich text rendering
-                                            textFormat = TextEdit.MarkdownText
-                                        }
-                                    }
                                 }
                             }
                             
@@ -14,12 +14,15 @@ Item {
     property var chatMessages: []   // [{role, content}]
     property string chatError: ""
     property var followups: []      // [{query}]
+    property var streamingDocument: null // rendered blocks of the message being streamed
+    property bool hasOlderMessages: false
 
     signal autoUpdateToggled(bool enabled)
     signal askChat(string text)
     signal openLinkInNewTab(string url)
     signal runNextFollowup()
     signal themeClicked(string theme)
+    signal loadOlderMessages()
 
     function setLoading(v) { loading = v }
     function setThemes(t) { themes = t; loading = false }
@@ -27,12 +30,10 @@ Item {
     function setChatMessages(m) { chatMessages = m }
     function setChatError(e) { chatError = e }
     function setFollowups(f) { followups = f }
-    function updateLastMessage(m) { 
-        // Update streaming content for smooth display
-        if (m.length > 0) {
-            chat.streamingContent = m[m.length - 1].content
-            chat.isStreaming = true
-        }
+    function updateLastMessage() {
+        // The streaming document re-renders only its open block; just keep scrolling
+        chat.isStreaming = true
+        chat.streamingTick++
     }
     function finishStreaming(m) {
         chat.isStreaming = false
@@ -125,6 +126,9 @@ Item {
                 messages: root.chatMessages
                 errorText: root.chatError
                 followups: root.followups
+                streamingDocument: root.streamingDocument
+                hasOlder: root.hasOlderMessages
+                onLoadOlder: () => root.loadOlderMessages()
                 onSend: (txt) => root.askChat(txt)
                 onOpenCitation: (url) => {
                     console.log("Opening link in new tab:", url)
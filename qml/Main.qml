@@ -14,44 +14,101 @@ Window {
     property int activeIndex: 0
     property string currentTitle: (tabStack.currentItem && tabStack.currentItem.title) ? tabStack.currentItem.title : ""
     property bool insightsPanelVisible: true
+    property int nextTabSerial: 0
+    property bool restoring: false // replaying the saved session; don't journal it again
+    property var deferredTabs: [] // restored tabs after the active one, created after the first frame
     
     ListModel {
         id: tabsModel
     }
 
     Component.onCompleted: {
-        let urls = session.loadTabs()
-        if (urls.length === 0) urls = ["https://example.com"]
-        
-        for (let url of urls) {
-            createTab(url)
+        // Only the active tab gets a page now; the rest load when first shown.
+        // Tabs after the active one are not even created until the first frame
+        startup.begin("restore tabs")
+        let tabs = session.restoredTabs()
+        let restoreIndex = Math.max(0, Math.min(session.loadActiveIndex(), tabs.length - 1))
+        restoring = true
+        for (let i = 0; i < tabs.length && i <= restoreIndex; i++) {
+            createTab(tabs[i].url, tabs[i].key, tabs[i].title, i !== restoreIndex)
         }
+        restoring = false
+        deferredTabs = tabs.slice(restoreIndex + 1)
+        if (tabsModel.count === 0) createTab("https://example.com")
         
-        activeIndex = Math.max(0, Math.min(session.loadActiveIndex(), tabsModel.count-1))
+        activeIndex = Math.min(restoreIndex, tabsModel.count - 1)
         tabBar.currentIndex = activeIndex
+        chat.activeConversation = tabsModel.get(activeIndex).tabKey
+        startup.end("restore tabs")
         
         // Connect analyzer and chat signals
         analyzer.themesReady.connect((themes) => insightContent.setThemes(themes))
+        analyzer.themesReadyFor.connect((key, themes) => {
+            let v = currentView()
+            if (v && v.tabKey === key) insightContent.setThemes(themes)
+        })
         analyzer.resultsReady.connect((items) => insightContent.setItems(items))
         // Don't show analyzer errors - just display empty themes if extraction fails
 
         chat.messagesChanged.connect(() => insightContent.setChatMessages(chat.messages))
-        chat.partialUpdated.connect(() => insightContent.updateLastMessage(chat.messages))
+        chat.partialUpdated.connect(() => insightContent.updateLastMessage())
         chat.streamingFinished.connect(() => insightContent.finishStreaming(chat.messages))
-        chat.followupsChanged.connect(() => insightContent.setFollowups(chat.followups))
         chat.error.connect((m) => insightContent.setChatError(m))
+        // Each tab has its own conversation; resync the panel when switching
+        chat.activeConversationChanged.connect(() => {
+            insightContent.setChatMessages(chat.messages)
+            if (chat.isStreaming()) insightContent.updateLastMessage()
+            else insightContent.finishStreaming(chat.messages)
+        })
         
         // Extract themes for initial page since insights panel is open by default
         Qt.callLater(refreshInsights)
     }
     
-    function createTab(url) {
-        tabsModel.append({ url: url, title: "", icon: "" })
-        let newView = webViewComponent.createObject(tabStack, {
-            profile: profile,
-            initialUrl: url,
-            tabIndex: tabsModel.count - 1
-        })
+    // Background tabs the first frame did not need; appended in their saved order
+    Connections {
+        target: startup
+        function onFirstFrame() {
+            if (deferredTabs.length === 0) return
+            startup.begin("restore background tabs")
+            restoring = true
+            for (let i = 0; i < deferredTabs.length; i++) {
+                createTab(deferredTabs[i].url, deferredTabs[i].key, deferredTabs[i].title, true)
+            }
+            restoring = false
+            deferredTabs = []
+            startup.end("restore background tabs")
+        }
+    }
+
+    function createTab(url, key, title, lazy, adopted) {
+        // Stable key used to address the tab's chat conversation; unique across
+        // sessions since it also names the conversation's journal on disk
+        if (!key) key = "tab-" + Date.now().toString(36) + "-" + (nextTabSerial++)
+        // A preloaded view may have followed redirects; the tab shows where it ended up
+        if (adopted) {
+            url = adopted.url.toString()
+            title = title || adopted.title
+        }
+        tabsModel.append({ url: url, title: title || "", icon: adopted ? adopted.icon.toString() : "", tabKey: key })
+        let newView
+        if (adopted) {
+            adopted.parent = tabStack
+            adopted.tabKey = key
+            adopted.tabIndex = tabsModel.count - 1
+            newView = adopted
+        } else {
+            newView = webViewComponent.createObject(tabStack, {
+                profile: profile,
+                initialUrl: url,
+                placeholderTitle: title || "",
+                materialized: !lazy,
+                tabKey: key,
+                tabIndex: tabsModel.count - 1
+            })
+        }
+        tabLifecycle.registerTab(key, url, !!lazy)
+        if (!restoring) session.tabAdded(tabsModel.count - 1, key, url)
         return newView
     }
 
@@ -60,7 +117,10 @@ Window {
         storageName: "MicroBrowserProfile"
         offTheRecord: false
         httpUserAgent: "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36 StatistaBrowser/1.0"
-        onDownloadRequested: (download) => downloadsPanel.handleDownload(download)
+        onDownloadRequested: (download) => {
+            downloadsLoader.active = true
+            downloadsLoader.item.handleDownload(download)
+        }
     }
 
     ColumnLayout {
@@ -78,10 +138,20 @@ Window {
                 onCurrentIndexChanged: {
                     root.activeIndex = currentIndex;
                     tabStack.currentIndex = currentIndex;
+                    // A restored placeholder tab loads its page on first activation
+                    if (currentView()) currentView().materialized = true;
+                    if (!restoring) session.tabActivated(currentIndex);
+                    if (currentIndex >= 0 && currentIndex < tabsModel.count) {
+                        chat.activeConversation = tabsModel.get(currentIndex).tabKey;
+                        tabLifecycle.activate(tabsModel.get(currentIndex).tabKey);
+                    }
                     urlField.text = currentView() ? currentView().url.toString() : "";
-                    // Auto-update themes when switching tabs
+                    // Auto-update themes when switching tabs; a tab whose page was
+                    // already analyzed (possibly in the background) shows its themes
                     if (insightsPanelVisible && insightContent.autoUpdate) {
-                        refreshInsights()
+                        let v = currentView()
+                        if (v && analyzer.hasCachedThemes(v.tabKey)) insightContent.setThemes(analyzer.cachedThemes(v.tabKey))
+                        else refreshInsights()
                     }
                 }
                 Repeater {
@@ -219,6 +289,10 @@ Window {
                 SplitView.preferredWidth: 600
                 SplitView.minimumWidth: 400
                 visible: insightsPanelVisible
+                streamingDocument: chat.streamingDocument
+                hasOlderMessages: chat.hasOlderMessages
+                followups: chat.followups
+                onLoadOlderMessages: () => chat.loadOlderMessages(50)
                 
                 onAutoUpdateToggled: (enabled) => {
                     if (enabled) {
@@ -230,13 +304,8 @@ Window {
                     
                     // For theme clicks, this receives "Search for statistics about: [theme]"
                     // Just send it to chat as-is with the context
-                    let v = currentView()
-                    let context = {
-                        "page": { "url": v ? v.url.toString() : "", "title": root.currentTitle },
-                        "selection": "",  // Theme clicks never have selected text
-                        "themes": insightContent.themes
-                    }
-                    chat.sendMessage(text, context)
+                    // Theme clicks never have selected text
+                    withChatContext("", (context) => chat.sendMessage(text, context))
                 }
                 onThemeClicked: (theme) => {
                     // Just handle the analyzer search
@@ -245,12 +314,7 @@ Window {
                 onOpenLinkInNewTab: (url) => addTab(url)
                 onRunNextFollowup: () => {
                     let v = currentView()
-                    let context = {
-                        "page": { "url": v ? v.url.toString() : "", "title": root.currentTitle },
-                        "selection": v ? v.getSelectionText() : "",
-                        "themes": insightContent.themes
-                    }
-                    chat.runFollowupQueue(context)
+                    withChatContext(v ? v.getSelectionText() : "", (context) => chat.runFollowupQueue(context))
                 }
             }
         }
@@ -266,7 +330,10 @@ Window {
                     }
                     if (tabIndex >= 0 && tabIndex < tabsModel.count) {
                         tabsModel.setProperty(tabIndex, "url", url.toString());
+                        session.tabNavigated(tabIndex, url.toString());
+                        tabLifecycle.recordUrl(tabKey, url.toString());
                     }
+                    analyzer.forgetThemes(tabKey);
                 }
                 
                 onLoadingChanged: (loadingInfo) => {
@@ -277,6 +344,15 @@ Window {
                         insightContent.autoUpdate) {
                         // Small delay to ensure content is rendered
                         Qt.callLater(refreshInsights)
+                    } else if (tabIndex >= 0 && tabBar.currentIndex !== tabIndex &&
+                               loadingInfo.status === WebEngineView.LoadSucceededStatus &&
+                               insightsPanelVisible &&
+                               insightContent.autoUpdate) {
+                        // Tabs opened in bulk finish loading in the background; their
+                        // extractions are batched by the analyzer
+                        extractVisibleText((txt) => {
+                            if (txt && txt.trim().length > 50) analyzer.queueThemeExtraction(tabKey, txt)
+                        })
                     }
                 }
                 
@@ -287,6 +363,7 @@ Window {
                     // Force tab bar to update
                     if (tabIndex >= 0 && tabIndex < tabsModel.count) {
                         tabsModel.setProperty(tabIndex, "title", title);
+                        session.tabRetitled(tabIndex, title);
                     }
                 }
                 
@@ -306,68 +383,70 @@ Window {
                     // 1. Call analyzer.searchTheme (like onThemeClicked does)
                     analyzer.searchTheme(text)
                     
-                    // 2. Send to chat (like onAskChat does)
-                    let v = currentView()
-                    let context = {
-                        "page": { "url": v ? v.url.toString() : "", "title": root.currentTitle },
-                        "selection": "",  // Keep empty like theme clicks
-                        "themes": insightContent.themes
-                    }
-                    chat.sendMessage("Search for statistics about: " + text, context)
+                    // 2. Send to chat (like onAskChat does), selection kept empty like theme clicks
+                    withChatContext("", (context) => chat.sendMessage("Search for statistics about: " + text, context))
                 }
             }
         }
     }
 
-    Drawer {
-        id: downloadsPanel
-        width: Math.min(520, root.width * 0.5)
-        height: parent.height
-        edge: Qt.RightEdge
-        modal: false
+    // Created on the first download; most sessions never need it
+    Loader {
+        id: downloadsLoader
+        active: false
+        sourceComponent: Component {
+            Drawer {
+                id: downloadsPanel
+                width: Math.min(520, root.width * 0.5)
+                parent: Overlay.overlay
+                height: root.height
+                edge: Qt.RightEdge
+                modal: false
 
-        property var items: []
+                property var items: []
 
-        function handleDownload(d) {
-            d.accept();
-            let rec = { request: d, fileName: d.downloadFileName, received: d.receivedBytes, total: d.totalBytes, state: d.state }
-            items.push(rec)
-            d.receivedBytesChanged.connect(() => { rec.received = d.receivedBytes; listView.forceLayout(); })
-            d.totalBytesChanged.connect(() => { rec.total = d.totalBytes; listView.forceLayout(); })
-            d.stateChanged.connect(() => { rec.state = d.state; listView.forceLayout(); })
-        }
+                function handleDownload(d) {
+                    d.accept();
+                    let rec = { request: d, fileName: d.downloadFileName, received: d.receivedBytes, total: d.totalBytes, state: d.state }
+                    items.push(rec)
+                    d.receivedBytesChanged.connect(() => { rec.received = d.receivedBytes; listView.forceLayout(); })
+                    d.totalBytesChanged.connect(() => { rec.total = d.totalBytes; listView.forceLayout(); })
+                    d.stateChanged.connect(() => { rec.state = d.state; listView.forceLayout(); })
+                }
 
-        ColumnLayout {
-            anchors.fill: parent
-            anchors.margins: 10
-            spacing: 8
-            Label { text: "Downloads"; font.bold: true; font.pointSize: 14 }
-            ListView {
-                id: listView
-                Layout.fillWidth: true; Layout.fillHeight: true
-                model: downloadsPanel.items
-                delegate: Frame {
-                    width: ListView.view.width
-                    ColumnLayout {
-                        anchors.fill: parent; spacing: 4
-                        Label { text: modelData.fileName }
-                        ProgressBar {
-                            indeterminate: modelData.total <= 0
-                            from: 0; to: modelData.total > 0 ? modelData.total : 1
-                            value: Math.max(0, modelData.received)
-                        }
-                        RowLayout {
-                            spacing: 8
-                            Label { text: (modelData.total>0) ? Math.round(100*modelData.received/Math.max(1,modelData.total)) + "%" : "" }
-                            Button {
-                                text: "Open"
-                                enabled: modelData.state === WebEngineDownloadRequest.DownloadCompleted
-                                onClicked: Qt.openUrlExternally(modelData.request.downloadDirectory + "/" + modelData.request.downloadFileName)
-                            }
-                            Button {
-                                text: "Cancel"
-                                enabled: modelData.state === WebEngineDownloadRequest.DownloadRequested || modelData.state === WebEngineDownloadRequest.DownloadInProgress
-                                onClicked: modelData.request.cancel()
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    spacing: 8
+                    Label { text: "Downloads"; font.bold: true; font.pointSize: 14 }
+                    ListView {
+                        id: listView
+                        Layout.fillWidth: true; Layout.fillHeight: true
+                        model: downloadsPanel.items
+                        delegate: Frame {
+                            width: ListView.view.width
+                            ColumnLayout {
+                                anchors.fill: parent; spacing: 4
+                                Label { text: modelData.fileName }
+                                ProgressBar {
+                                    indeterminate: modelData.total <= 0
+                                    from: 0; to: modelData.total > 0 ? modelData.total : 1
+                                    value: Math.max(0, modelData.received)
+                                }
+                                RowLayout {
+                                    spacing: 8
+                                    Label { text: (modelData.total>0) ? Math.round(100*modelData.received/Math.max(1,modelData.total)) + "%" : "" }
+                                    Button {
+                                        text: "Open"
+                                        enabled: modelData.state === WebEngineDownloadRequest.DownloadCompleted
+                                        onClicked: Qt.openUrlExternally(modelData.request.downloadDirectory + "/" + modelData.request.downloadFileName)
+                                    }
+                                    Button {
+                                        text: "Cancel"
+                                        enabled: modelData.state === WebEngineDownloadRequest.DownloadRequested || modelData.state === WebEngineDownloadRequest.DownloadInProgress
+                                        onClicked: modelData.request.cancel()
+                                    }
+                                }
                             }
                         }
                     }
@@ -376,6 +455,93 @@ Window {
         }
     }
 
+    // Hidden views for cited pages, sized like the tab area so pages lay out as they will be shown
+    Item {
+        id: preloadPool
+        visible: false
+        width: tabStack.width
+        height: tabStack.height
+        property var views: ({}) // by the url passed to preloadRequested
+
+        Connections {
+            target: citationPreloader
+            function onPreloadRequested(url) {
+                let v = webViewComponent.createObject(preloadPool, {
+                    profile: profile,
+                    initialUrl: url,
+                    materialized: true,
+                    tabIndex: -1
+                })
+                preloadPool.views[url] = v
+                v.loadingChanged.connect((info) => {
+                    if (v.tabIndex >= 0) return // adopted as a tab meanwhile
+                    if (info.status === WebEngineView.LoadSucceededStatus) citationPreloader.loadFinished(url, true)
+                    else if (info.status === WebEngineView.LoadFailedStatus) citationPreloader.loadFinished(url, false)
+                })
+            }
+            function onReleaseRequested(url) {
+                let v = preloadPool.views[url]
+                delete preloadPool.views[url]
+                if (v) v.destroy()
+            }
+        }
+    }
+
+    // Debug overlay: approximate memory per subsystem, tab states and token usage
+    Shortcut {
+        sequence: "Ctrl+Shift+M"
+        onActivated: memoryOverlayLoader.active = !memoryOverlayLoader.active
+    }
+
+    Loader {
+        id: memoryOverlayLoader
+        active: false
+        z: 100
+        anchors.top: parent.top
+        anchors.right: parent.right
+        anchors.margins: 8
+        sourceComponent: Component {
+            Rectangle {
+                id: memoryOverlay
+                width: memoryText.implicitWidth + 16
+                height: memoryText.implicitHeight + 16
+                radius: 4
+                color: "#cc000000"
+
+                function kib(bytes) { return Math.round((bytes || 0) / 1024) + " KiB" }
+
+                Text {
+                    id: memoryText
+                    x: 8; y: 8
+                    color: "white"
+                    font.family: "monospace"
+                    font.pointSize: 10
+                    text: {
+                        const s = memoryStats.snapshot
+                        const c = s.chat || {}
+                        const t = tabLifecycle.stats()
+                        const p = citationPreloader.stats()
+                        return "messages     " + memoryOverlay.kib(c.messages) + "\n"
+                             + "buffers      " + memoryOverlay.kib(c.buffers) + "\n"
+                             + "tool state   " + memoryOverlay.kib(c.toolState) + "\n"
+                             + "citations    " + memoryOverlay.kib(c.citations) + "\n"
+                             + "passages     " + memoryOverlay.kib(c.passageIndex) + "\n"
+                             + "answers      " + memoryOverlay.kib(c.answerCache) + "\n"
+                             + "total        " + memoryOverlay.kib(s.total) + " / " + memoryOverlay.kib(s.highWater) + "\n"
+                             + "evictions    " + (s.evictions || 0) + " (" + memoryOverlay.kib(s.evictedBytes) + ")\n"
+                             + "tabs         " + (t.active || 0) + " active, " + (t.frozen || 0) + " frozen, "
+                                               + (t.discarded || 0) + " discarded (~" + (t.estimatedMb || 0) + " MB)\n"
+                             + "preloads     " + (p.ready || 0) + "/" + (p.pooled || 0) + " ready, "
+                                               + (p.hits || 0) + " hits, " + (p.wasted || 0) + " wasted"
+                                               + (p.enabled ? "" : " (off)") + "\n"
+                             + "tokens       " + (usage.totals.tokens || 0)
+                                               + " ($" + Number(usage.totals.costUsd || 0).toFixed(3) + ")"
+                    }
+                }
+            }
+        }
+    }
+
     function refreshInsights() {
         let v = currentView()
         if (!v) {
@@ -386,7 +552,7 @@ Window {
             // Only show loading if there's actual text to analyze
             if (txt && txt.trim().length > 50) {
                 insightContent.setLoading(true)
-                analyzer.analyzeTextLLM(txt)
+                analyzer.extractThemesNow(v.tabKey, txt)
             } else {
                 // Clear themes for pages with no/little content
                 insightContent.setThemes([])
@@ -394,6 +560,26 @@ Window {
         })
     }
 
+    // Builds the chat context for the current tab; the page text is extracted
+    // asynchronously so ChatBridge can pick relevant passages from it
+    function withChatContext(selection, cb) {
+        let v = currentView()
+        let context = {
+            "page": { "url": v ? v.url.toString() : "", "title": root.currentTitle },
+            "selection": selection,
+            "themes": insightContent.themes,
+            "pageText": ""
+        }
+        if (!v) {
+            cb(context)
+            return
+        }
+        v.extractVisibleText((txt) => {
+            context.pageText = txt
+            cb(context)
+        })
+    }
+
     function openUrl(u) {
         let url = u.trim();
         if (url.length === 0) return;
@@ -411,7 +597,11 @@ Window {
         }
     }
     function addTab(u) { 
-        createTab(u);
+        // Cited pages may already be loaded in a hidden view
+        let key = citationPreloader.take(u)
+        let preloaded = key ? preloadPool.views[key] : null
+        if (key) delete preloadPool.views[key]
+        createTab(u, undefined, undefined, false, preloaded);
         tabBar.currentIndex = tabsModel.count - 1;
     }
     function closeTab(idx) {
@@ -421,8 +611,12 @@ Window {
         let view = tabStack.children[idx];
         if (view) view.destroy();
         
-        // Remove from model
+        // Remove from model, dropping the tab's conversation
+        chat.closeConversation(tabsModel.get(idx).tabKey);
+        tabLifecycle.unregisterTab(tabsModel.get(idx).tabKey);
+        analyzer.forgetThemes(tabsModel.get(idx).tabKey);
         tabsModel.remove(idx);
+        session.tabClosed(idx);
         
         // Update indices for remaining tabs
         for (let i = idx; i < tabStack.children.length; i++) {
@@ -450,10 +644,7 @@ Window {
     }
 
     onClosing: (e) => {
-        let urls = []
-        for (let i = 0; i < tabsModel.count; i++) {
-            urls.push(tabsModel.get(i).url)
-        }
-        session.saveTabs(urls, tabBar.currentIndex)
+        // Tab changes are already journaled; leave a compact snapshot behind
+        session.compact()
     }
-}
\ No newline at end of file
+}
@@ -4,53 +4,80 @@ import QtQuick.Controls
 
 Item {
     id: root
-    property alias url: view.url
-    property alias title: view.title
-    property alias icon: view.icon
     property url initialUrl: "https://example.com"
-    property alias profile: view.profile
+    property var profile: null
+    // Restored background tabs start as placeholders without a WebEngine page;
+    // the page is created (and loaded) once the tab is first shown
+    property bool materialized: true
+    property string placeholderTitle: ""
+    property string tabKey: ""
+    // Last state asked for by tabLifecycle, and a scroll position to return to
+    // once a discarded page has reloaded
+    property int requestedState: 0
+    property real restoreScrollY: -1
+    property url url: initialUrl
+    readonly property string title: view ? view.title : placeholderTitle
+    readonly property url icon: view ? view.icon : ""
+    readonly property var view: viewLoader.item
     signal newTabRequested(url u)
     signal loadingChanged(var loadingInfo)
     signal sendSelectionToChat(string text)
 
-    WebEngineView {
-        id: view
+    // Navigation requested from outside (address bar) reaches the page here
+    onUrlChanged: if (view && view.url.toString() !== url.toString()) view.url = url
+
+    Loader {
+        id: viewLoader
         anchors.fill: parent
-        url: initialUrl
-
-        settings.javascriptEnabled: true
-        settings.localStorageEnabled: true
-        settings.pluginsEnabled: true
-        settings.javascriptCanOpenWindows: true
-        settings.allowRunningInsecureContent: false
-        settings.autoLoadImages: true
-
-        onNewWindowRequested: (request) => {
-            if (request.userInitiated) {
-                root.newTabRequested(request.requestedUrl);
-            }
-        }
-        
-        onLoadingChanged: (loadingInfo) => {
-            root.loadingChanged(loadingInfo)
-        }
-        
-        onContextMenuRequested: (request) => {
-            // Accept the request immediately to prevent default menu
-            request.accepted = true
-
-            // Get selected text
-            view.runJavaScript("window.getSelection().toString()", (selectedText) => {
-                if (selectedText && selectedText.trim().length > 0) {
-                    contextMenu.selectedText = selectedText
-                    contextMenu.x = request.position.x
-                    contextMenu.y = request.position.y
-                    contextMenu.open()
+        active: root.materialized
+        sourceComponent: webEngineComponent
+    }
+
+    Component {
+        id: webEngineComponent
+        WebEngineView {
+            id: view
+            profile: root.profile
+            Component.onCompleted: url = root.url
+            onUrlChanged: if (root.url.toString() !== url.toString()) root.url = url
+
+            settings.javascriptEnabled: true
+            settings.localStorageEnabled: true
+            settings.pluginsEnabled: true
+            settings.javascriptCanOpenWindows: true
+            settings.allowRunningInsecureContent: false
+            settings.autoLoadImages: true
+
+            onNewWindowRequested: (request) => {
+                if (request.userInitiated) {
+                    root.newTabRequested(request.requestedUrl);
                 }
-            })
+            }
+
+            onLoadingChanged: (loadingInfo) => {
+                // A discarded page reloaded on activation returns to where it was
+                if (loadingInfo.status === WebEngineView.LoadSucceededStatus && root.restoreScrollY >= 0)
+                    root.restoreScroll()
+                root.loadingChanged(loadingInfo)
+            }
+
+            onContextMenuRequested: (request) => {
+                // Accept the request immediately to prevent default menu
+                request.accepted = true
+
+                // Get selected text
+                view.runJavaScript("window.getSelection().toString()", (selectedText) => {
+                    if (selectedText && selectedText.trim().length > 0) {
+                        contextMenu.selectedText = selectedText
+                        contextMenu.x = request.position.x
+                        contextMenu.y = request.position.y
+                        contextMenu.open()
+                    }
+                })
+            }
         }
     }
-    
+
     Menu {
         id: contextMenu
         property string selectedText: ""
@@ -81,25 +108,76 @@ Item {
         }
     }
 
+    // Background tabs are frozen/discarded by the lifecycle manager
+    Connections {
+        target: tabLifecycle
+        function onStateRequested(key, state) {
+            if (key === root.tabKey) root.applyLifecycle(state)
+        }
+    }
+
+    // Apply a tabLifecycle state (values match WebEngineView.LifecycleState)
+    function applyLifecycle(state) {
+        requestedState = state
+        if (state === WebEngineView.LifecycleState.Active) {
+            if (!materialized) {
+                materialized = true
+                return
+            }
+            if (!view) return
+            if (view.lifecycleState === WebEngineView.LifecycleState.Discarded) {
+                restoreScrollY = tabLifecycle.snapshot(tabKey).scrollY || -1
+            }
+            view.lifecycleState = WebEngineView.LifecycleState.Active
+            return
+        }
+        if (!view || view.lifecycleState === state) return
+        if (view.lifecycleState !== WebEngineView.LifecycleState.Active) {
+            // Frozen pages can't run scripts; the snapshot was taken on freezing
+            view.lifecycleState = state
+            return
+        }
+        // Remember where the user was before the page goes away
+        tabLifecycle.recordScroll(tabKey, view.scrollPosition.y)
+        view.runJavaScript("document.body ? document.body.innerText : ''", (result) => {
+            tabLifecycle.recordText(tabKey, result || "")
+            // The tab may have been brought back while the script ran
+            if (view && requestedState === state) view.lifecycleState = state
+        })
+    }
+
+    function restoreScroll() {
+        const y = restoreScrollY
+        restoreScrollY = -1
+        // Only return to the old position if the page still has the same text
+        extractVisibleText((txt) => {
+            if (!tabLifecycle.recordText(tabKey, txt) && view) {
+                view.runJavaScript("window.scrollTo(0, " + y + ")")
+            }
+        })
+    }
+
     function extractVisibleText(cb) {
+        if (!view) { cb(""); return }
         view.runJavaScript("document.body ? document.body.innerText : ''", (result) => cb(result || ""))
     }
 
     function getSelectionText() {
         var s = ""
+        if (!view) return s
         view.runJavaScript("window.getSelection ? window.getSelection().toString() : ''", (result) => { s = result || "" })
         return s
     }
     
     function goBack() {
-        view.goBack()
+        if (view) view.goBack()
     }
     
     function goForward() {
-        view.goForward()
+        if (view) view.goForward()
     }
     
     function reload() {
-        view.reload()
+        if (view) view.reload()
     }
 }
\ No newline at end of file
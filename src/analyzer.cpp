@@ -9,15 +9,95 @@
 #include <QRegularExpression>
 #include <QDebug>
 #include <QDateTime>
+#include <QTimer>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QSettings>
+#include <QCryptographicHash>
+#include <algorithm>
+#include <utility>
+#include "config.h"
+#include "toolregistry.h"
+#include "usageledger.h"
+#include "themebackend.h"
 
-Analyzer::Analyzer(QObject* parent) : QObject(parent) {
+namespace {
+// Below this many samples the tracker's percentiles are too noisy to act on
+constexpr int kMinLatencySamples = 5;
+constexpr int kMinHedgeDelayMs = 200;
+constexpr int kBaseBackoffMs = 250;
+constexpr int kLocalResultLimit = 12;
+constexpr int kIndexSaveDelayMs = 5000;
+// Page text sent per document for theme extraction
+constexpr int kThemeTextChars = 2000;
+// Shared by single and batched requests; each appends its output format
+constexpr const char* kThemeSystemPrompt =
+    "You are a theme extraction assistant specialized in identifying statistical research topics. Your task is to analyze text and extract 3-5 key themes that would be valuable for statistical analysis and data research. Focus on:\n1. Economic trends and indicators\n2. Social patterns and demographics\n3. Industry-specific metrics\n4. Consumer behavior patterns\n5. Technology adoption trends\n6. Healthcare and public health statistics\n7. Environmental and sustainability metrics\n\n";
+
+QList<QVariantMap> toVariantList(const QVector<StatIndex::Record>& records) {
+    QList<QVariantMap> items;
+    for (const auto& r : records) items << StatIndex::toVariant(r);
+    return items;
+}
+}
+
+// In-flight state of one logical tools/call across retries and hedges
+struct Analyzer::ToolCall {
+    QString name;
+    QJsonObject arguments;
+    std::function<void(const QJsonObject&)> onDone;
+    int attempt{0};
+    int inFlight{0};
+    bool hedged{false};
+    bool done{false};
+    bool sessionRenewed{false};
+    QElapsedTimer started;
+    QList<QPointer<QNetworkReply>> replies;
+};
+
+Analyzer::Analyzer(QObject* parent)
+    : QObject(parent),
+      m_breaker(Config::getMcpBreakerThreshold(), Config::getMcpBreakerCooldownMs()),
+      m_maxRetries(Config::getMcpMaxRetries()),
+      m_minTimeoutMs(Config::getMcpMinTimeoutMs()),
+      m_maxTimeoutMs(Config::getMcpMaxTimeoutMs()),
+      m_statIndex(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/statindex.dat"),
+      m_themeBackends(&m_anthropicApiKey) {
     // Session ID will be provided by server after initialization
     qDebug() << "Analyzer: Created (session ID will be set by server)";
+
+    m_statIndex.load();
+    // Coalesce index writes; results tend to arrive in bursts
+    m_indexSaveTimer.setSingleShot(true);
+    m_indexSaveTimer.setInterval(kIndexSaveDelayMs);
+    connect(&m_indexSaveTimer, &QTimer::timeout, this, [this](){ m_statIndex.save(); });
+
+    // Extraction jobs from several tabs within the window share one request
+    m_themeBatchMax = qMax(1, Config::getThemeBatchMaxDocs());
+    m_themeBatchTimer.setSingleShot(true);
+    m_themeBatchTimer.setInterval(qMax(0, Config::getThemeBatchWindowMs()));
+    connect(&m_themeBatchTimer, &QTimer::timeout, this, &Analyzer::flushThemeBatch);
+}
+
+Analyzer::~Analyzer() {
+    if (m_statIndex.isDirty()) m_statIndex.save();
 }
 
 void Analyzer::initializeSession() {
-    if (m_sessionInitialized) return; // Already initialized
-    if (m_endpoint.isEmpty()) { emit error("Endpoint not configured"); return; }
+    if (m_sessionInitialized || m_initializing) return; // Already initialized or handshake running
+    if (m_endpoint.isEmpty()) {
+        emit error("Endpoint not configured");
+        flushSessionWaiters(false);
+        return;
+    }
+
+    // Warm start: reuse the session negotiated on a previous launch, no handshake
+    if (resumePersistedSession()) {
+        flushSessionWaiters(true);
+        refreshToolList();
+        return;
+    }
     
     QJsonObject payload{
         {"jsonrpc","2.0"},
@@ -38,22 +118,128 @@ void Analyzer::initializeSession() {
     };
     
     qDebug() << "Analyzer: Initializing MCP session...";
-    postJsonRpc(payload, [this](const QJsonObject& obj){
-        if (obj.contains("result")) {
+    m_initializing = true;
+    sendJsonRpc(payload, m_maxTimeoutMs, [this](const RpcOutcome& outcome){
+        m_initializing = false;
+        if (!outcome.ok) {
+            emit error(outcome.errorString);
+            flushSessionWaiters(false);
+            return;
+        }
+        if (outcome.body.contains("result")) {
             m_sessionInitialized = true; // Mark as initialized only on success
             qDebug() << "Analyzer: Session initialized successfully";
-            qDebug() << "Analyzer: Server response:" << QJsonDocument(obj).toJson(QJsonDocument::Compact);
-            // Note: Session ID should be extracted from response headers in postJsonRpc
+            qDebug() << "Analyzer: Server response:" << QJsonDocument(outcome.body).toJson(QJsonDocument::Compact);
+            // Session ID was extracted from the response headers in sendJsonRpc
+            persistSession(outcome.body["result"].toObject());
         }
+        flushSessionWaiters(m_sessionInitialized);
+        if (m_sessionInitialized) refreshToolList();
     });
 }
 
+void Analyzer::refreshToolList() {
+    if (!m_tools) return;
+    // Runs in the background; until it answers, the cached (or built-in) tools are used
+    QJsonObject payload{
+        {"jsonrpc", "2.0"},
+        {"id", m_nextRpcId++},
+        {"method", "tools/list"},
+        {"params", QJsonObject{}}
+    };
+    qDebug() << "Analyzer: Refreshing MCP tool list";
+    sendJsonRpc(payload, m_maxTimeoutMs, [this](const RpcOutcome& outcome){
+        if (!m_tools) return;
+        if (outcome.notModified) {
+            qDebug() << "Analyzer: Tool list unchanged (ETag match)";
+            return;
+        }
+        if (!outcome.ok || !outcome.body.contains("result")) {
+            qDebug() << "Analyzer: tools/list failed, keeping cached tools:" << outcome.errorString;
+            return;
+        }
+        m_tools->updateFromList(outcome.body["result"].toObject().value("tools").toArray(), outcome.etag);
+    }, m_tools->etag());
+}
+
+bool Analyzer::resumePersistedSession() {
+    QSettings s;
+    s.beginGroup("mcp");
+    const bool matches = s.value("endpoint").toString() == m_endpoint &&
+                         s.value("keyHash").toByteArray() == apiKeyHash();
+    if (!matches) {
+        s.endGroup();
+        return false;
+    }
+    m_sessionId = s.value("sessionId").toString();
+    m_protocolVersion = s.value("protocolVersion").toString();
+    m_serverCapabilities = QJsonDocument::fromJson(s.value("capabilities").toByteArray()).object();
+    s.endGroup();
+
+    m_sessionInitialized = true;
+    qDebug() << "Analyzer: Resumed persisted MCP session" << m_sessionId;
+    return true;
+}
+
+void Analyzer::persistSession(const QJsonObject& initializeResult) {
+    m_protocolVersion = initializeResult.value("protocolVersion").toString();
+    m_serverCapabilities = initializeResult.value("capabilities").toObject();
+
+    QSettings s;
+    s.beginGroup("mcp");
+    s.setValue("endpoint", m_endpoint);
+    s.setValue("keyHash", apiKeyHash());
+    s.setValue("sessionId", m_sessionId);
+    s.setValue("protocolVersion", m_protocolVersion);
+    s.setValue("capabilities", QJsonDocument(m_serverCapabilities).toJson(QJsonDocument::Compact));
+    s.endGroup();
+}
+
+void Analyzer::forgetSession() {
+    m_sessionInitialized = false;
+    m_sessionId.clear();
+    QSettings s;
+    s.remove("mcp");
+}
+
+QByteArray Analyzer::apiKeyHash() const {
+    // Tie persisted sessions to the key without storing the key itself
+    return QCryptographicHash::hash(m_apiKey.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+}
+
+void Analyzer::whenSessionReady(std::function<void(bool)> onReady) {
+    if (m_sessionInitialized) {
+        onReady(true);
+        return;
+    }
+    m_sessionWaiters.append(std::move(onReady));
+    initializeSession();
+}
+
+void Analyzer::flushSessionWaiters(bool ready) {
+    // Swap first: waiters may queue again (e.g. a call hitting a fresh expiry)
+    QList<std::function<void(bool)>> waiters;
+    waiters.swap(m_sessionWaiters);
+    for (const auto& waiter : waiters) waiter(ready);
+}
+
+void Analyzer::handleSessionExpired() {
+    // Another call already noticed and started the re-handshake
+    if (m_initializing || !m_sessionInitialized) return;
+    qDebug() << "Analyzer: MCP session expired, re-initializing in background";
+    forgetSession();
+    initializeSession();
+}
+
 void Analyzer::setEndpoint(const QString& e) {
     if (m_endpoint == e) return;
     m_endpoint = e;
     emit endpointChanged();
+    // A different endpoint means a different session
+    m_sessionInitialized = false;
+    m_sessionId.clear();
     // Try to initialize session if both endpoint and API key are set
-    if (!m_endpoint.isEmpty() && !m_apiKey.isEmpty()) {
+    if (!m_deferSessionInit && !m_endpoint.isEmpty() && !m_apiKey.isEmpty()) {
         initializeSession();
     }
 }
@@ -62,8 +248,10 @@ void Analyzer::setApiKey(const QString& k) {
     if (m_apiKey == k) return;
     m_apiKey = k;
     emit apiKeyChanged();
+    m_sessionInitialized = false;
+    m_sessionId.clear();
     // Try to initialize session if both endpoint and API key are set
-    if (!m_endpoint.isEmpty() && !m_apiKey.isEmpty()) {
+    if (!m_deferSessionInit && !m_endpoint.isEmpty() && !m_apiKey.isEmpty()) {
         initializeSession();
     }
 }
@@ -101,104 +289,223 @@ void Analyzer::analyzeTextFast(const QString& text) {
     // searchStatista(themes);
 }
 
-void Analyzer::analyzeTextLLM(const QString& text) {
+bool Analyzer::themesOffline(const QString& text, QStringList* themes) const {
     // Skip analysis if text is empty or too short
     if (text.trimmed().isEmpty() || text.trimmed().length() < 50) {
         qDebug() << "Analyzer: Text too short or empty, skipping analysis";
-        emit themesReady(QStringList());  // Emit empty themes list
+        *themes = QStringList();
+        return true;
+    }
+
+    // Theme extraction is optional work; past the soft token budget only a
+    // free local backend may run, otherwise use the naive extractor
+    const bool overBudget = m_usage && !m_usage->allowsBackgroundWork();
+    if (m_themeBackends.order(overBudget).isEmpty()) {
+        qDebug() << "Analyzer:" << (overBudget ? "Token budget exceeded," : "No theme backend configured,")
+                 << "using naive theme extraction";
+        *themes = extractThemesNaive(text);
+        return true;
+    }
+    return false;
+}
+
+void Analyzer::analyzeTextLLM(const QString& text) {
+    QStringList themes;
+    if (themesOffline(text, &themes)) {
+        emit themesReady(themes);
         return;
     }
-    
-    // Use Anthropic Claude to extract themes from the text
-    if (m_anthropicApiKey.isEmpty()) {
-        qDebug() << "Analyzer: No Anthropic API key configured, falling back to naive extraction";
-        auto themes = extractThemesNaive(text);
+    requestThemes({ThemeJob{QString(), text}}, [this](const QString&, const QStringList& themes){
         emit themesReady(themes);
+    });
+}
+
+void Analyzer::queueThemeExtraction(const QString& key, const QString& text) {
+    QStringList themes;
+    if (themesOffline(text, &themes)) {
+        m_tabThemes.insert(key, themes);
+        emit themesReadyFor(key, themes);
         return;
     }
-    
-    QJsonArray messages;
-    messages.append(QJsonObject{
-        {"role", "user"},
-        {"content", QString("Extract themes from this text:\n\n%1").arg(text.left(2000))} // Limit text to avoid token limits
+    // A newer page in the same tab replaces its pending job
+    for (auto& job : m_themeBatch) {
+        if (job.key == key) {
+            job.text = text;
+            return;
+        }
+    }
+    m_themeBatch.append(ThemeJob{key, text});
+    if (m_themeBatch.size() >= m_themeBatchMax) flushThemeBatch();
+    else if (!m_themeBatchTimer.isActive()) m_themeBatchTimer.start();
+}
+
+void Analyzer::extractThemesNow(const QString& key, const QString& text) {
+    QStringList themes;
+    if (themesOffline(text, &themes)) {
+        m_tabThemes.insert(key, themes);
+        emit themesReadyFor(key, themes);
+        return;
+    }
+    // The visible tab doesn't wait for the batch window; a queued job for it is superseded
+    m_themeBatch.removeIf([&key](const ThemeJob& job){ return job.key == key; });
+    if (m_themeBatch.isEmpty()) m_themeBatchTimer.stop();
+    requestThemes({ThemeJob{key, text}}, [this](const QString& key, const QStringList& themes){
+        m_tabThemes.insert(key, themes);
+        emit themesReadyFor(key, themes);
     });
-    
-    QJsonObject payload{
-        {"model", "claude-3-5-haiku-20241022"},
-        {"system", "You are a theme extraction assistant specialized in identifying statistical research topics. Your task is to analyze text and extract 3-5 key themes that would be valuable for statistical analysis and data research. Focus on:\n1. Economic trends and indicators\n2. Social patterns and demographics\n3. Industry-specific metrics\n4. Consumer behavior patterns\n5. Technology adoption trends\n6. Healthcare and public health statistics\n7. Environmental and sustainability metrics\n\nReturn only the themes as a simple comma-separated list. Be specific and actionable for statistical searches."},
-        {"messages", messages},
-        {"max_tokens", 100},
-        {"temperature", 0.3}
-    };
-    
-    QNetworkRequest req(QUrl("https://api.anthropic.com/v1/messages"));
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    req.setRawHeader("x-api-key", m_anthropicApiKey.toUtf8());
-    req.setRawHeader("anthropic-version", "2023-06-01");
-    
-    qDebug() << "Analyzer: Calling Claude API for theme extraction";
-    
-    auto* reply = m_net.post(req, QJsonDocument(payload).toJson());
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, text](){
+}
+
+void Analyzer::flushThemeBatch() {
+    m_themeBatchTimer.stop();
+    if (m_themeBatch.isEmpty()) return;
+    const QList<ThemeJob> jobs = std::exchange(m_themeBatch, {});
+    requestThemes(jobs, [this](const QString& key, const QStringList& themes){
+        m_tabThemes.insert(key, themes);
+        emit themesReadyFor(key, themes);
+    });
+}
+
+QStringList Analyzer::parseThemeList(const QString& textContent) {
+    // Parse themes - look for the last line or comma-separated values
+    QStringList themes;
+    auto lines = textContent.split("\n", Qt::SkipEmptyParts);
+
+    // Try to find themes in the response
+    for (const QString& line : lines) {
+        // Skip lines with colons or explanation text
+        if (line.contains(":") && !line.contains(",")) continue;
+
+        // Process comma-separated themes
+        for (const QString& theme : line.split(",", Qt::SkipEmptyParts)) {
+            QString cleanTheme = theme.trimmed().toLower();
+            // Skip filler words
+            if (cleanTheme.startsWith("based on") ||
+                cleanTheme.startsWith("here are") ||
+                cleanTheme.length() < 3) continue;
+            themes << cleanTheme;
+        }
+    }
+
+    // Limit to 5 themes
+    while (themes.size() > 5) themes.removeLast();
+    return themes;
+}
+
+QHash<QString, QStringList> Analyzer::parseThemeBatch(const QString& textContent) {
+    // {"1": ["theme", ...], "2": [...]}; tolerate prose or a code fence around it
+    QHash<QString, QStringList> out;
+    const int open = textContent.indexOf('{');
+    const int close = textContent.lastIndexOf('}');
+    if (open < 0 || close <= open) return out;
+    const QJsonObject obj = QJsonDocument::fromJson(textContent.mid(open, close - open + 1).toUtf8()).object();
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        QStringList themes;
+        for (const auto& v : it.value().toArray()) {
+            const QString theme = v.toString().trimmed().toLower();
+            if (theme.length() >= 3 && themes.size() < 5) themes << theme;
+        }
+        out.insert(it.key(), themes);
+    }
+    return out;
+}
+
+// One theme extraction request as it falls through the ranked backends
+struct Analyzer::ThemeRequest {
+    QList<ThemeJob> jobs;
+    QString system;
+    QString prompt;
+    int maxTokens{0};
+    QVector<ThemeBackend*> backends;
+    std::function<void(const QString&, const QStringList&)> deliver;
+};
+
+void Analyzer::requestThemes(const QList<ThemeJob>& jobs, std::function<void(const QString&, const QStringList&)> deliver) {
+    const bool batched = jobs.size() > 1;
+    auto request = std::make_shared<ThemeRequest>();
+    request->jobs = jobs;
+    request->deliver = std::move(deliver);
+    request->maxTokens = 100 * int(jobs.size());
+    if (batched) {
+        // Documents are numbered in the request rather than sent with tab keys
+        request->prompt = "Extract themes from each document below.\n";
+        for (int i = 0; i < jobs.size(); ++i) {
+            request->prompt += QString("\n<document id=\"%1\">\n%2\n</document>\n").arg(i + 1).arg(jobs.at(i).text.left(kThemeTextChars));
+        }
+    } else {
+        request->prompt = QString("Extract themes from this text:\n\n%1").arg(jobs.first().text.left(kThemeTextChars)); // Limit text to avoid token limits
+    }
+    const QString format = batched
+        ? QStringLiteral("Return only a JSON object mapping each document id to an array of its themes, e.g. {\"1\": [\"theme\", \"theme\"], \"2\": [\"theme\"]}. Be specific and actionable for statistical searches.")
+        : QStringLiteral("Return only the themes as a simple comma-separated list. Be specific and actionable for statistical searches.");
+    request->system = QString(kThemeSystemPrompt) + format;
+    // Past the soft token budget only free (local) backends may run
+    request->backends = m_themeBackends.order(m_usage && !m_usage->allowsBackgroundWork());
+    tryThemeBackend(request, 0);
+}
+
+void Analyzer::tryThemeBackend(const std::shared_ptr<ThemeRequest>& request, int index) {
+    // Skip backends whose breaker is open; once all are exhausted use the local extractor
+    while (index < request->backends.size() && !m_themeBackends.allowRequest(request->backends.at(index))) ++index;
+    if (index >= request->backends.size()) {
+        qDebug() << "Analyzer: No theme backend available, falling back to naive extraction";
+        for (const auto& job : request->jobs) request->deliver(job.key, extractThemesNaive(job.text));
+        return;
+    }
+
+    ThemeBackend* backend = request->backends.at(index);
+    qDebug() << "Analyzer: Theme extraction of" << request->jobs.size() << "document(s) via" << backend->name() << backend->model();
+
+    QElapsedTimer started;
+    started.start();
+    auto* reply = m_net.post(backend->request(), backend->body(request->system, request->prompt, request->maxTokens));
+    QTimer::singleShot(backend->timeoutMs(), reply, [reply](){
+        if (reply->isRunning()) reply->abort();
+    });
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request, index, backend, started](){
         reply->deleteLater();
-        
+
+        auto failOver = [&](const QString& why) {
+            qDebug() << "Analyzer: Theme backend" << backend->name() << "failed:" << why;
+            m_themeBackends.recordFailure(backend);
+            tryThemeBackend(request, index + 1);
+        };
+
         if (reply->error() != QNetworkReply::NoError) {
-            qDebug() << "Analyzer: Claude API error:" << reply->errorString();
             qDebug() << "Analyzer: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
             auto errorData = reply->readAll();
             if (!errorData.isEmpty()) {
-                qDebug() << "Analyzer: Error response:" << errorData;
+                qDebug() << "Analyzer: Error response:" << errorData.left(500);
             }
-            // Fall back to naive extraction
-            auto themes = extractThemesNaive(text);
-            emit themesReady(themes);
+            failOver(reply->errorString());
             return;
         }
-        
+
         auto doc = QJsonDocument::fromJson(reply->readAll());
         if (!doc.isObject()) {
-            qDebug() << "Analyzer: Invalid Claude API response";
-            auto themes = extractThemesNaive(text);
-            emit themesReady(themes);
+            failOver("invalid response");
             return;
         }
-        
-        auto obj = doc.object();
-        auto content = obj["content"].toArray();
-        if (!content.isEmpty() && content[0].isObject()) {
-            auto textContent = content[0].toObject()["text"].toString();
-            // Parse themes - look for the last line or comma-separated values
-            QStringList themes;
-            auto lines = textContent.split("\n", Qt::SkipEmptyParts);
-            
-            // Try to find themes in the response
-            for (const QString& line : lines) {
-                // Skip lines with colons or explanation text
-                if (line.contains(":") && !line.contains(",")) continue;
-                
-                // Process comma-separated themes
-                for (const QString& theme : line.split(",", Qt::SkipEmptyParts)) {
-                    QString cleanTheme = theme.trimmed().toLower();
-                    // Skip filler words
-                    if (cleanTheme.startsWith("based on") || 
-                        cleanTheme.startsWith("here are") ||
-                        cleanTheme.length() < 3) continue;
-                    themes << cleanTheme;
-                }
-            }
-            
-            // Limit to 5 themes
-            while (themes.size() > 5) themes.removeLast();
-            
-            if (themes.isEmpty()) {
-                themes = extractThemesNaive(text);
-            }
-            qDebug() << "Analyzer: Claude extracted themes:" << themes;
-            emit themesReady(themes);
-        } else {
-            qDebug() << "Analyzer: No content in Claude response";
-            auto themes = extractThemesNaive(text);
-            emit themesReady(themes);
+
+        const QJsonObject obj = doc.object();
+        if (m_usage && backend->isMetered() && obj.contains("usage")) {
+            m_usage->record(UsageLedger::Origin::ThemeExtraction, QString(), backend->model(), backend->usage(obj));
+        }
+        const QString textContent = backend->replyText(obj);
+        if (textContent.trimmed().isEmpty()) {
+            failOver("no content");
+            return;
+        }
+        m_themeBackends.recordSuccess(backend, started.elapsed(), request->jobs.size());
+
+        const bool batched = request->jobs.size() > 1;
+        const QHash<QString, QStringList> perDoc = batched ? parseThemeBatch(textContent) : QHash<QString, QStringList>();
+        for (int i = 0; i < request->jobs.size(); ++i) {
+            const ThemeJob& job = request->jobs.at(i);
+            QStringList themes = batched ? perDoc.value(QString::number(i + 1)) : parseThemeList(textContent);
+            // A document the model skipped still gets themes
+            if (themes.isEmpty()) themes = extractThemesNaive(job.text);
+            qDebug() << "Analyzer:" << backend->name() << "extracted themes:" << themes;
+            request->deliver(job.key, themes);
         }
     });
 }
@@ -211,19 +518,8 @@ void Analyzer::searchTheme(const QString& theme) {
 
 void Analyzer::getStatisticById(const QString& id) {
     if (m_endpoint.isEmpty()) { emit error("Endpoint not configured"); return; }
-    QJsonObject payload{
-        {"jsonrpc","2.0"},
-        {"id", 3},
-        {"method","tools/call"},
-        {"params", QJsonObject{
-            {"name", "get-chart-data-by-id"},
-            {"arguments", QJsonObject{
-                {"id", id}
-            }}
-        }},
-        // Session ID goes in header, not body
-    };
-    postJsonRpc(payload, [this](const QJsonObject& obj){
+    callTool("get-chart-data-by-id", QJsonObject{{"id", id}}, [this](const QJsonObject& obj){
+        if (obj.value("error").isString()) { emit error(obj.value("error").toString()); return; }
         if (obj.contains("result")) {
             auto result = obj["result"].toObject();
             if (result.contains("content")) {
@@ -245,20 +541,33 @@ void Analyzer::getStatisticById(const QString& id) {
 
 void Analyzer::searchStatista(const QStringList& themes) {
     if (m_endpoint.isEmpty()) { emit error("Endpoint not configured"); return; }
-    QJsonObject payload{
-        {"jsonrpc","2.0"},
-        {"id", 2},
-        {"method","tools/call"},
-        {"params", QJsonObject{
-            {"name", "search-statistics"},
-            {"arguments", QJsonObject{
-                {"query", themes.join(" ")},
-                {"limit", 12}
-            }}
-        }}
-        // Session ID goes in header, not body
+    const QString query = themes.join(" ");
+    QJsonObject arguments{
+        {"query", query},
+        {"limit", 12}
     };
-    postJsonRpc(payload, [this](const QJsonObject& obj){
+
+    // Show provisional hits from the local index while the live search runs
+    auto local = m_statIndex.search(query, kLocalResultLimit);
+    if (!local.isEmpty()) {
+        qDebug() << "Analyzer: Showing" << local.size() << "provisional local results for" << query;
+        emit resultsReady(toVariantList(local));
+    }
+
+    callTool("search-statistics", arguments, [this, query](const QJsonObject& obj){
+        if (obj.value("error").isString()) {
+            // Endpoint slow or down: keep serving from the local index if it has anything
+            auto offline = m_statIndex.search(query, kLocalResultLimit);
+            if (!offline.isEmpty()) {
+                qDebug() << "Analyzer: Live search failed, serving" << offline.size() << "offline results";
+                emit resultsReady(toVariantList(offline));
+                return;
+            }
+            emit error(obj.value("error").toString());
+            return;
+        }
+        // Indexes every response shape handled below
+        indexToolResponse(obj);
         QJsonArray arr;
         if (obj.contains("result")) {
             auto result = obj["result"].toObject();
@@ -298,7 +607,8 @@ void Analyzer::searchStatista(const QStringList& themes) {
     });
 }
 
-void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const QJsonObject&)> onOk) {
+QNetworkReply* Analyzer::sendJsonRpc(const QJsonObject& payload, int timeoutMs, std::function<void(const RpcOutcome&)> onDone,
+                                     const QByteArray& ifNoneMatch) {
     qDebug() << "Analyzer: Posting to" << m_endpoint;
     qDebug() << "Analyzer: API key present:" << !m_apiKey.isEmpty();
     qDebug() << "Analyzer: Session ID:" << m_sessionId;
@@ -312,6 +622,7 @@ void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const
     if (!m_sessionId.isEmpty()) {
         req.setRawHeader("mcp-session-id", m_sessionId.toUtf8());
     }
+    if (!ifNoneMatch.isEmpty()) req.setRawHeader("If-None-Match", ifNoneMatch);
     
     qDebug() << "Analyzer: Headers being sent:";
     auto headers = req.rawHeaderList();
@@ -320,18 +631,45 @@ void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const
     }
 
     auto* reply = m_net.post(req, QJsonDocument(payload).toJson());
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, onOk](){
+
+    // Abort the reply if it outlives its deadline; the timer dies with the reply
+    auto timedOut = std::make_shared<bool>(false);
+    if (timeoutMs > 0) {
+        QTimer::singleShot(timeoutMs, reply, [reply, timedOut, timeoutMs](){
+            if (!reply->isRunning()) return;
+            qDebug() << "Analyzer: Request timed out after" << timeoutMs << "ms";
+            *timedOut = true;
+            reply->abort();
+        });
+    }
+
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, onDone, timedOut](){
         reply->deleteLater();
         
         // Extract session ID from response headers if present
         if (reply->hasRawHeader("mcp-session-id")) {
-            m_sessionId = QString::fromUtf8(reply->rawHeader("mcp-session-id"));
-            qDebug() << "Analyzer: Got session ID from server:" << m_sessionId;
+            const QString sessionId = QString::fromUtf8(reply->rawHeader("mcp-session-id"));
+            if (sessionId != m_sessionId) {
+                m_sessionId = sessionId;
+                qDebug() << "Analyzer: Got session ID from server:" << m_sessionId;
+                if (m_sessionInitialized) QSettings().setValue("mcp/sessionId", m_sessionId);
+            }
+        }
+
+        RpcOutcome outcome;
+        outcome.timedOut = *timedOut;
+        outcome.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        outcome.etag = reply->rawHeader("ETag");
+        if (outcome.httpStatus == 304) {
+            outcome.ok = true;
+            outcome.notModified = true;
+            onDone(outcome);
+            return;
         }
         
         if (reply->error() != QNetworkReply::NoError) { 
             qDebug() << "Analyzer: Network error:" << reply->error() << reply->errorString();
-            qDebug() << "Analyzer: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            qDebug() << "Analyzer: HTTP status:" << outcome.httpStatus;
             
             // Try to read error response
             auto errorData = reply->readAll();
@@ -339,7 +677,14 @@ void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const
                 qDebug() << "Analyzer: Error response:" << errorData;
             }
             
-            emit error(QString("Network: %1").arg(reply->errorString())); 
+            outcome.errorString = outcome.timedOut
+                ? QString("Network: request timed out")
+                : QString("Network: %1").arg(reply->errorString());
+            // MCP servers answer 404 for terminated sessions; some use 400 with a session message
+            outcome.sessionExpired = m_sessionInitialized &&
+                (outcome.httpStatus == 404 ||
+                 (outcome.httpStatus == 400 && errorData.contains("ession")));
+            onDone(outcome);
             return; 
         }
         auto responseData = reply->readAll();
@@ -362,7 +707,9 @@ void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const
                 }
             }
             if (!result.isEmpty()) {
-                onOk(result);
+                outcome.ok = true;
+                outcome.body = result;
+                onDone(outcome);
                 return;
             }
         }
@@ -371,30 +718,184 @@ void Analyzer::postJsonRpc(const QJsonObject& payload, std::function<void(const
         auto doc = QJsonDocument::fromJson(responseData);
         if (!doc.isObject()) { 
             qDebug() << "Analyzer: Invalid JSON response:" << responseData.left(200);
-            emit error("Bad response"); 
+            outcome.errorString = "Bad response";
+            onDone(outcome);
             return; 
         }
-        onOk(doc.object());
+        outcome.ok = true;
+        outcome.body = doc.object();
+        const QString rpcError = outcome.body.value("error").toObject().value("message").toString();
+        if (m_sessionInitialized && rpcError.contains("session", Qt::CaseInsensitive)) {
+            outcome.ok = false;
+            outcome.sessionExpired = true;
+            outcome.errorString = rpcError;
+        }
+        onDone(outcome);
     });
+    return reply;
 }
 
-void Analyzer::executeMCPTool(const QString& toolName, const QJsonObject& params, const QString& requestId) {
-    // Session ID is no longer required by Statista MCP server
-    // Just check that we've completed initialization
-    if (!m_sessionInitialized) {
-        emit toolResult(requestId, QJsonObject{{"error", "Session not initialized"}});
+bool Analyzer::isIdempotentTool(const QString& toolName) const {
+    // Read-only tools (per the server's readOnlyHint) are safe to retry and to duplicate
+    if (m_tools) return m_tools->isReadOnly(toolName);
+    static const QSet<QString> idempotent{"search-statistics", "get-chart-data-by-id"};
+    return idempotent.contains(toolName);
+}
+
+bool Analyzer::isRetryable(const RpcOutcome& outcome) {
+    // Timeouts, connection failures (no HTTP status), throttling and server errors are transient
+    return outcome.timedOut || outcome.httpStatus == 0 || outcome.httpStatus == 429 || outcome.httpStatus >= 500;
+}
+
+bool Analyzer::countsAsOutage(const RpcOutcome& outcome) {
+    // Timeouts, connection failures (no HTTP status) and server errors
+    return outcome.timedOut || outcome.httpStatus == 0 || outcome.httpStatus >= 500;
+}
+
+int Analyzer::adaptiveTimeoutMs(const QString& toolName) const {
+    if (m_latency.sampleCount(toolName) < kMinLatencySamples) return m_maxTimeoutMs;
+    qint64 p95 = m_latency.percentile(toolName, 0.95);
+    return int(std::clamp<qint64>(p95 * 3, m_minTimeoutMs, m_maxTimeoutMs));
+}
+
+void Analyzer::callTool(const QString& toolName, const QJsonObject& arguments, std::function<void(const QJsonObject&)> onDone) {
+    if (!m_breaker.allowRequest()) {
+        qDebug() << "Analyzer: Circuit open, failing fast for" << toolName;
+        onDone(QJsonObject{{"error", "Statista is currently unavailable, please try again shortly"}});
         return;
     }
 
-    postJsonRpc({
+    auto call = std::make_shared<ToolCall>();
+    call->name = toolName;
+    call->arguments = arguments;
+    call->onDone = std::move(onDone);
+    startToolAttempt(call);
+}
+
+void Analyzer::startToolAttempt(const std::shared_ptr<ToolCall>& call) {
+    call->hedged = false;
+    call->started.start();
+    sendToolRequest(call, false);
+
+    // Hedge: if the call runs past its p95, race a duplicate request against it
+    if (!isIdempotentTool(call->name) || m_latency.sampleCount(call->name) < kMinLatencySamples) return;
+    int hedgeDelay = int(qMax<qint64>(kMinHedgeDelayMs, m_latency.percentile(call->name, 0.95)));
+    int attempt = call->attempt;
+    QTimer::singleShot(hedgeDelay, this, [this, call, attempt](){
+        if (call->done || call->hedged || call->attempt != attempt || call->inFlight == 0) return;
+        call->hedged = true;
+        qDebug() << "Analyzer: Hedging" << call->name << "after" << call->started.elapsed() << "ms";
+        sendToolRequest(call, true);
+    });
+}
+
+void Analyzer::sendToolRequest(const std::shared_ptr<ToolCall>& call, bool hedge) {
+    QJsonObject payload{
         {"jsonrpc", "2.0"},
         {"method", "tools/call"},
-        {"id", QDateTime::currentMSecsSinceEpoch()},
+        {"id", m_nextRpcId++},
         {"params", QJsonObject{
-            {"name", toolName},
-            {"arguments", params}
+            {"name", call->name},
+            {"arguments", call->arguments}
         }}
-    }, [this, requestId](const QJsonObject& result){
-        emit toolResult(requestId, result);
+    };
+
+    int attempt = call->attempt;
+    call->inFlight++;
+    auto* reply = sendJsonRpc(payload, adaptiveTimeoutMs(call->name), [this, call, attempt, hedge](const RpcOutcome& outcome){
+        call->inFlight--;
+        // Losing hedges and replies from superseded attempts are ignored
+        if (call->done || call->attempt != attempt) return;
+
+        // Any answer from the server, even a client error or an expired session,
+        // shows it is up; this also settles a half-open probe either way
+        if (countsAsOutage(outcome)) m_breaker.recordFailure();
+        else m_breaker.recordSuccess();
+
+        if (outcome.sessionExpired && !call->sessionRenewed) {
+            // Park the call until the background re-handshake finishes, then replay it once
+            call->sessionRenewed = true;
+            call->attempt++;
+            handleSessionExpired();
+            whenSessionReady([this, call](bool ready){
+                if (ready) startToolAttempt(call);
+                else finishToolCall(call, QJsonObject{{"error", "Session not initialized"}});
+            });
+            return;
+        }
+
+        if (outcome.ok) {
+            m_latency.record(call->name, call->started.elapsed());
+            if (hedge) qDebug() << "Analyzer: Hedged request won for" << call->name;
+            finishToolCall(call, outcome.body);
+            return;
+        }
+
+        if (call->inFlight > 0) return; // The other hedge may still succeed
+
+        if (isIdempotentTool(call->name) && isRetryable(outcome) && call->attempt < m_maxRetries &&
+            m_breaker.state() != CircuitBreaker::State::Open) {
+            // Exponential backoff with jitter: base * 2^attempt plus up to the same again
+            int backoff = kBaseBackoffMs << call->attempt;
+            int delay = backoff + int(QRandomGenerator::global()->bounded(backoff));
+            call->attempt++;
+            qDebug() << "Analyzer: Retrying" << call->name << "attempt" << call->attempt << "in" << delay << "ms";
+            QTimer::singleShot(delay, this, [this, call](){ startToolAttempt(call); });
+            return;
+        }
+
+        finishToolCall(call, QJsonObject{{"error", outcome.errorString}});
+    });
+    call->replies << reply;
+}
+
+void Analyzer::finishToolCall(const std::shared_ptr<ToolCall>& call, const QJsonObject& response) {
+    call->done = true;
+    for (const auto& reply : call->replies) {
+        if (reply && reply->isRunning()) reply->abort();
+    }
+    call->replies.clear();
+    call->onDone(response);
+}
+
+void Analyzer::indexToolResponse(const QJsonObject& response) {
+    if (!response.contains("result")) return;
+    int added = m_statIndex.addToolResponse(response);
+    if (added > 0) qDebug() << "Analyzer: Indexed" << added << "statistics, local index size:" << m_statIndex.size();
+    // Also when only the recency of known statistics changed
+    if (m_statIndex.isDirty()) m_indexSaveTimer.start();
+}
+
+QList<QVariantMap> Analyzer::searchLocal(const QString& query, int limit) const {
+    return toVariantList(m_statIndex.search(query, limit));
+}
+
+void Analyzer::executeMCPTool(const QString& toolName, const QJsonObject& params, const QString& requestId) {
+    // Calls arriving before the session is ready (cold start or re-handshake) are queued
+    whenSessionReady([this, toolName, params, requestId](bool ready){
+        if (!ready) {
+            auto offline = toolName == "search-statistics"
+                ? m_statIndex.search(params.value("query").toString(), kLocalResultLimit)
+                : QVector<StatIndex::Record>();
+            if (!offline.isEmpty()) {
+                emit toolResult(requestId, StatIndex::toToolResponse(offline));
+            } else {
+                emit toolResult(requestId, QJsonObject{{"error", "Session not initialized"}});
+            }
+            return;
+        }
+
+        callTool(toolName, params, [this, toolName, params, requestId](const QJsonObject& result){
+            if (result.value("error").isString() && toolName == "search-statistics") {
+                auto offline = m_statIndex.search(params.value("query").toString(), kLocalResultLimit);
+                if (!offline.isEmpty()) {
+                    qDebug() << "Analyzer: Tool call failed, answering from local index with" << offline.size() << "results";
+                    emit toolResult(requestId, StatIndex::toToolResponse(offline));
+                    return;
+                }
+            }
+            indexToolResponse(result);
+            emit toolResult(requestId, result);
+        });
     });
 }
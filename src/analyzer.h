@@ -2,6 +2,17 @@
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QJsonObject>
+#include <QTimer>
+#include <QHash>
+#include <functional>
+#include <memory>
+#include "mcpresilience.h"
+#include "statindex.h"
+#include "themebackend.h"
+
+class ToolRegistry;
+class UsageLedger;
 
 class Analyzer : public QObject {
     Q_OBJECT
@@ -10,6 +21,7 @@ class Analyzer : public QObject {
     Q_PROPERTY(QString anthropicApiKey READ anthropicApiKey WRITE setAnthropicApiKey NOTIFY anthropicApiKeyChanged)
 public:
     explicit Analyzer(QObject* parent=nullptr);
+    ~Analyzer() override;
 
     QString endpoint() const { return m_endpoint; }
     void setEndpoint(const QString& e);
@@ -17,27 +29,92 @@ public:
     void setApiKey(const QString& k);
     QString anthropicApiKey() const { return m_anthropicApiKey; }
     void setAnthropicApiKey(const QString& k);
+    void setToolRegistry(ToolRegistry* registry) { m_tools = registry; }
+    void setUsageLedger(UsageLedger* usage) { m_usage = usage; }
+    // Keep the endpoint/key setters from starting the MCP handshake; startup
+    // calls initializeSession() once the first frame is up (tool calls still
+    // start it on demand)
+    void setDeferSessionInit(bool defer) { m_deferSessionInit = defer; }
 
     Q_INVOKABLE void initializeSession();
     Q_INVOKABLE void analyzeTextFast(const QString& text);
     Q_INVOKABLE void analyzeTextLLM(const QString& text);
+    // Like analyzeTextLLM for the tab with the given key, but jobs from several
+    // tabs arriving within a short window go out as one request; answered by themesReadyFor
+    Q_INVOKABLE void queueThemeExtraction(const QString& key, const QString& text);
+    // Same, sent at once without batching; for the visible tab
+    Q_INVOKABLE void extractThemesNow(const QString& key, const QString& text);
+    // Themes last extracted for a tab until it navigates (forgetThemes) or closes
+    Q_INVOKABLE QStringList cachedThemes(const QString& key) const { return m_tabThemes.value(key); }
+    Q_INVOKABLE bool hasCachedThemes(const QString& key) const { return m_tabThemes.contains(key); }
+    Q_INVOKABLE void forgetThemes(const QString& key) { m_tabThemes.remove(key); }
     Q_INVOKABLE void searchStatista(const QStringList& themes);
     Q_INVOKABLE void searchTheme(const QString& theme);
     Q_INVOKABLE void getStatisticById(const QString& id);
     Q_INVOKABLE void executeMCPTool(const QString& toolName, const QJsonObject& params, const QString& requestId);
+    Q_INVOKABLE QList<QVariantMap> searchLocal(const QString& query, int limit = 12) const;
+    Q_INVOKABLE QVariantMap themeBackendStats() const { return m_themeBackends.stats(); }
 
 signals:
     void endpointChanged();
     void apiKeyChanged();
     void anthropicApiKeyChanged();
     void themesReady(const QStringList& themes);
+    void themesReadyFor(const QString& key, const QStringList& themes);
     void resultsReady(const QList<QVariantMap>& items);
     void error(const QString& message);
     void toolResult(const QString& requestId, const QJsonObject& result);
 
 private:
+    struct RpcOutcome {
+        bool ok{false};
+        bool timedOut{false};
+        bool sessionExpired{false};
+        bool notModified{false}; // 304 for a conditional request
+        int httpStatus{0};
+        QByteArray etag;
+        QString errorString;
+        QJsonObject body;
+    };
+    struct ToolCall;
+    struct ThemeJob {
+        QString key;
+        QString text;
+    };
+
     QStringList extractThemesNaive(const QString& text) const;
-    void postJsonRpc(const QJsonObject& payload, std::function<void(const QJsonObject&)> onOk);
+    // Themes that need no LLM call (too little text, over budget, no key)
+    bool themesOffline(const QString& text, QStringList* themes) const;
+    void flushThemeBatch();
+    struct ThemeRequest;
+    void requestThemes(const QList<ThemeJob>& jobs, std::function<void(const QString&, const QStringList&)> deliver);
+    void tryThemeBackend(const std::shared_ptr<ThemeRequest>& request, int index);
+    static QStringList parseThemeList(const QString& textContent);
+    static QHash<QString, QStringList> parseThemeBatch(const QString& textContent);
+    QNetworkReply* sendJsonRpc(const QJsonObject& payload, int timeoutMs, std::function<void(const RpcOutcome&)> onDone,
+                               const QByteArray& ifNoneMatch = QByteArray());
+
+    // Resilient tools/call: adaptive timeout, hedging, retries and circuit breaking.
+    // onDone receives the JSON-RPC response, or {"error": message} on transport failure.
+    void callTool(const QString& toolName, const QJsonObject& arguments, std::function<void(const QJsonObject&)> onDone);
+    void startToolAttempt(const std::shared_ptr<ToolCall>& call);
+    void sendToolRequest(const std::shared_ptr<ToolCall>& call, bool hedge);
+    void finishToolCall(const std::shared_ptr<ToolCall>& call, const QJsonObject& response);
+    int adaptiveTimeoutMs(const QString& toolName) const;
+    bool isIdempotentTool(const QString& toolName) const;
+    static bool isRetryable(const RpcOutcome& outcome);
+    static bool countsAsOutage(const RpcOutcome& outcome);
+
+    // Session lifecycle: persisted across launches, renewed in the background on expiry
+    bool resumePersistedSession();
+    void persistSession(const QJsonObject& initializeResult);
+    void forgetSession();
+    QByteArray apiKeyHash() const;
+    void whenSessionReady(std::function<void(bool ready)> onReady);
+    void flushSessionWaiters(bool ready);
+    void handleSessionExpired();
+    void refreshToolList();
+    void indexToolResponse(const QJsonObject& response);
 
     QNetworkAccessManager m_net;
     QString m_endpoint;
@@ -45,4 +122,28 @@ private:
     QString m_anthropicApiKey;
     QString m_sessionId;
     bool m_sessionInitialized{false};
+    bool m_initializing{false};
+    bool m_deferSessionInit{false};
+    QString m_protocolVersion;
+    QJsonObject m_serverCapabilities;
+    QList<std::function<void(bool)>> m_sessionWaiters;
+    qint64 m_nextRpcId{100};
+
+    LatencyTracker m_latency;
+    CircuitBreaker m_breaker;
+    int m_maxRetries;
+    int m_minTimeoutMs;
+    int m_maxTimeoutMs;
+
+    ToolRegistry* m_tools{nullptr};
+    UsageLedger* m_usage{nullptr};
+    StatIndex m_statIndex;
+    QTimer m_indexSaveTimer;
+
+    // Anthropic and/or a local OpenAI-compatible server, ranked by latency
+    ThemeBackends m_themeBackends;
+    QList<ThemeJob> m_themeBatch;
+    QTimer m_themeBatchTimer;
+    int m_themeBatchMax{1};
+    QHash<QString, QStringList> m_tabThemes;
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "answercache.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QDebug>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+constexpr quint32 kMagic = 0x414E5343; // "ANSC"
+constexpr quint32 kVersion = 1;
+}
+
+AnswerCache::AnswerCache(const QString& path, int ttlHours, int maxEntries)
+    : m_path(path), m_ttlMs(qint64(ttlHours) * 3600 * 1000), m_maxEntries(maxEntries) {}
+
+bool AnswerCache::load() {
+    if (!isEnabled()) return false;
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&f);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        qDebug() << "AnswerCache: Ignoring incompatible cache file" << m_path;
+        return false;
+    }
+    in >> count;
+
+    m_entries.clear();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QByteArray key;
+        Entry e;
+        in >> key >> e.text >> e.citations >> e.model >> e.storedAt;
+        if (now - e.storedAt < m_ttlMs) m_entries.insert(key, e);
+    }
+    m_dirty = m_entries.size() != int(count);
+    qDebug() << "AnswerCache: Loaded" << m_entries.size() << "answers from" << m_path;
+    return in.status() == QDataStream::Ok;
+}
+
+bool AnswerCache::save() {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile f(m_path);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&f);
+    out << kMagic << kVersion << quint32(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        out << it.key() << it->text << it->citations << it->model << it->storedAt;
+    }
+    if (!f.commit()) return false;
+    m_dirty = false;
+    return true;
+}
+
+QString AnswerCache::normalizeQuestion(const QString& question) {
+    static const QRegularExpression themePrefix("^(tell me about statistics related to|search for statistics about)\\s+");
+    static const QRegularExpression punctuation("[^\\w\\s]");
+    static const QRegularExpression spaces("\\s+");
+    QString q = question.toLower().trimmed();
+    // Both theme templates ask the same thing
+    q.replace(themePrefix, "theme: ");
+    q.replace(punctuation, " ");
+    q.replace(spaces, " ");
+    return q.trimmed();
+}
+
+QByteArray AnswerCache::keyFor(const QString& question, const QVariantMap& context, const QString& model,
+                               const QByteArray& thread) {
+    const QVariantMap page = context.value("page").toMap();
+    QByteArray pageKey = page.value("url").toString().toUtf8();
+    if (pageKey.isEmpty() && !context.value("pageText").toString().isEmpty()) {
+        pageKey = QCryptographicHash::hash(context.value("pageText").toString().toUtf8(),
+                                           QCryptographicHash::Sha1).toHex();
+    }
+    const QString selection = context.value("selection").toString().trimmed();
+
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    h.addData(normalizeQuestion(question).toUtf8());
+    h.addData(QByteArrayView("\n"));
+    h.addData(pageKey);
+    h.addData(QByteArrayView("\n"));
+    h.addData(selection.toUtf8());
+    h.addData(QByteArrayView("\n"));
+    h.addData(model.toUtf8());
+    // First questions of a thread keep the key they had before threads counted
+    if (!thread.isEmpty()) {
+        h.addData(QByteArrayView("\n"));
+        h.addData(thread);
+    }
+    return h.result().toHex();
+}
+
+bool AnswerCache::lookup(const QByteArray& key, Entry* out) const {
+    if (!isEnabled()) return false;
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.cend()) return false;
+    if (QDateTime::currentMSecsSinceEpoch() - it->storedAt >= m_ttlMs) return false;
+    *out = *it;
+    return true;
+}
+
+void AnswerCache::store(const QByteArray& key, const Entry& entry) {
+    if (!isEnabled() || entry.text.trimmed().isEmpty()) return;
+    Entry e = entry;
+    if (e.storedAt == 0) e.storedAt = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(key, e);
+    prune();
+    m_dirty = true;
+}
+
+void AnswerCache::prune() {
+    if (m_entries.size() <= m_maxEntries) return;
+    // Evict the oldest answers first
+    QVector<QPair<qint64, QByteArray>> byAge;
+    byAge.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) byAge.append({it->storedAt, it.key()});
+    std::sort(byAge.begin(), byAge.end());
+    for (int i = 0; i < byAge.size() - m_maxEntries; ++i) m_entries.remove(byAge.at(i).second);
+}
+
+qint64 AnswerCache::approxBytes() const {
+    qint64 bytes = 0;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        bytes += it.key().size() + (it->text.size() + it->model.size()) * 2 + 64;
+        for (const auto& c : it->citations) {
+            const QVariantMap m = c.toMap();
+            for (auto f = m.cbegin(); f != m.cend(); ++f) bytes += (f.key().size() + f.value().toString().size()) * 2;
+        }
+    }
+    return bytes;
+}
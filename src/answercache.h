@@ -0,0 +1,47 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+#include <QVariantList>
+#include <QVariantMap>
+
+// Persisted cache of final chat answers, keyed by normalized question, page
+// (URL, or a hash of its text when there is no URL), model and prior turns. Repeated theme
+// queries and re-asked questions replay from here instead of re-running the
+// tool loop. Entries expire after a TTL; the oldest are evicted past a cap.
+class AnswerCache {
+public:
+    struct Entry {
+        QString text;
+        QVariantList citations;
+        QString model;
+        qint64 storedAt{0}; // ms since epoch
+    };
+
+    AnswerCache(const QString& path, int ttlHours, int maxEntries = 200);
+
+    bool isEnabled() const { return m_ttlMs > 0; }
+    bool load();
+    bool save();
+    bool isDirty() const { return m_dirty; }
+
+    static QString normalizeQuestion(const QString& question);
+    // thread identifies the conversation so far (empty for its first question),
+    // since a follow-up like "and in 2020?" means something else in another thread
+    static QByteArray keyFor(const QString& question, const QVariantMap& context, const QString& model,
+                             const QByteArray& thread = QByteArray());
+
+    bool lookup(const QByteArray& key, Entry* out) const;
+    void store(const QByteArray& key, const Entry& entry);
+    // Rough heap footprint of the entries, for memory accounting
+    qint64 approxBytes() const;
+
+private:
+    void prune();
+
+    QString m_path;
+    qint64 m_ttlMs;
+    int m_maxEntries;
+    QHash<QByteArray, Entry> m_entries;
+    bool m_dirty{false};
+};
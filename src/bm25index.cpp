@@ -0,0 +1,104 @@
+#include "bm25index.h"
+#include <QRegularExpression>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kK1 = 1.2;
+constexpr double kB = 0.75;
+}
+
+QStringList Bm25Index::tokenize(const QString& text) {
+    static const QRegularExpression splitter("\\W+", QRegularExpression::UseUnicodePropertiesOption);
+    static const QSet<QString> stop = QSet<QString>({
+        "the","a","an","and","or","to","of","in","on","for","is","are","was","were","with","as","by","at","from","that","this","it","be"
+    });
+    QStringList out;
+    for (const QString& raw : text.toLower().split(splitter, Qt::SkipEmptyParts)) {
+        if (raw.size() < 2 || stop.contains(raw)) continue;
+        out << raw;
+    }
+    return out;
+}
+
+int Bm25Index::addDocument(const QString& text) {
+    const int doc = m_docs.size();
+    m_docs.append(DocInfo{});
+    ++m_liveDocs;
+    indexDocument(doc, text);
+    return doc;
+}
+
+void Bm25Index::replaceDocument(int doc, const QString& text) {
+    if (doc < 0 || doc >= m_docs.size() || !m_docs[doc].live) return;
+    removeDocument(doc);
+    m_docs[doc].live = true;
+    ++m_liveDocs;
+    indexDocument(doc, text);
+}
+
+void Bm25Index::indexDocument(int doc, const QString& text) {
+    const QStringList tokens = tokenize(text);
+    QHash<QString, int> tf;
+    for (const QString& t : tokens) tf[t] += 1;
+
+    DocInfo& info = m_docs[doc];
+    info.length = tokens.size();
+    info.terms.reserve(tf.size());
+    for (auto it = tf.cbegin(); it != tf.cend(); ++it) {
+        m_postings[it.key()].append(Posting{doc, it.value()});
+        info.terms << it.key();
+    }
+    m_totalLength += info.length;
+}
+
+void Bm25Index::removeDocument(int doc) {
+    if (doc < 0 || doc >= m_docs.size() || !m_docs[doc].live) return;
+    DocInfo& info = m_docs[doc];
+    for (const QString& term : info.terms) {
+        auto it = m_postings.find(term);
+        if (it == m_postings.end()) continue;
+        it->erase(std::remove_if(it->begin(), it->end(), [doc](const Posting& p){ return p.doc == doc; }), it->end());
+        if (it->isEmpty()) m_postings.erase(it);
+    }
+    m_totalLength -= info.length;
+    info.terms.clear();
+    info.live = false;
+    --m_liveDocs;
+}
+
+void Bm25Index::clear() {
+    m_postings.clear();
+    m_docs.clear();
+    m_totalLength = 0;
+    m_liveDocs = 0;
+}
+
+QVector<Bm25Index::Hit> Bm25Index::search(const QString& query, int limit) const {
+    QVector<Hit> hits;
+    if (m_liveDocs == 0 || limit <= 0) return hits;
+
+    const double avgLength = double(m_totalLength) / m_liveDocs;
+    QHash<int, double> scores;
+    QSet<QString> seen;
+    for (const QString& term : tokenize(query)) {
+        if (seen.contains(term)) continue;
+        seen.insert(term);
+        auto it = m_postings.constFind(term);
+        if (it == m_postings.constEnd()) continue;
+        const double df = it->size();
+        const double idf = std::log(1.0 + (m_liveDocs - df + 0.5) / (df + 0.5));
+        for (const Posting& p : *it) {
+            const double len = m_docs.at(p.doc).length;
+            const double norm = p.tf * (kK1 + 1.0) / (p.tf + kK1 * (1.0 - kB + kB * len / avgLength));
+            scores[p.doc] += idf * norm;
+        }
+    }
+
+    hits.reserve(scores.size());
+    for (auto it = scores.cbegin(); it != scores.cend(); ++it) hits.append(Hit{it.key(), it.value()});
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b){ return a.score > b.score; });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+
+// Minimal in-memory Okapi BM25 full-text index. Documents are identified by the
+// dense integer returned from addDocument(); callers keep their own payloads.
+class Bm25Index {
+public:
+    struct Hit {
+        int doc;
+        double score;
+    };
+
+    static QStringList tokenize(const QString& text);
+
+    int addDocument(const QString& text);
+    void removeDocument(int doc);
+    // Re-index a live document under the same id
+    void replaceDocument(int doc, const QString& text);
+    void clear();
+
+    QVector<Hit> search(const QString& query, int limit) const;
+    int documentCount() const { return m_liveDocs; }
+
+private:
+    struct Posting {
+        int doc;
+        int tf;
+    };
+    struct DocInfo {
+        int length{0};
+        QStringList terms; // distinct terms, needed for removal
+        bool live{true};
+    };
+
+    void indexDocument(int doc, const QString& text);
+
+    QHash<QString, QVector<Posting>> m_postings;
+    QVector<DocInfo> m_docs;
+    qint64 m_totalLength{0};
+    int m_liveDocs{0};
+};
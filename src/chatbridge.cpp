@@ -3,12 +3,43 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QNetworkRequest>
-#include <QDateTime>
 #include <QDebug>
+#include <QStandardPaths>
+#include "config.h"
+#include "memorystats.h"
+
+namespace {
+const QString kDefaultConversation = QStringLiteral("default");
+// Hidden conversation used for background answer refreshes
+const QString kRefreshConversation = QStringLiteral("__answer-refresh");
+// Prefix of the hidden conversations answering follow-ups speculatively
+const QString kSpeculationPrefix = QStringLiteral("__speculate-");
+constexpr int kAnswerSaveDelayMs = 5000;
+
+QString pageUrlOf(const QVariantMap& context) {
+    return context.value("page").toMap().value("url").toString();
+}
+}
+
+ChatBridge::ChatBridge(QObject* parent)
+    : QObject(parent),
+      m_activeKey(kDefaultConversation),
+      m_answers(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/answers.dat",
+                Config::getAnswerCacheTtlHours()) {
+    m_answers.load();
+    m_answerSaveTimer.setSingleShot(true);
+    m_answerSaveTimer.setInterval(kAnswerSaveDelayMs);
+    connect(&m_answerSaveTimer, &QTimer::timeout, this, [this](){ m_answers.save(); });
 
-ChatBridge::ChatBridge(QObject* parent) : QObject(parent) {
     // Session ID will be provided by server after initialization
     qDebug() << "ChatBridge: Created (session ID will be set by server)";
+    conversation(m_activeKey);
+}
+
+ChatBridge::~ChatBridge() {
+    // Conversations reference m_net and m_passages, so they must go first
+    qDeleteAll(m_conversations);
+    if (m_answers.isDirty()) m_answers.save();
 }
 
 void ChatBridge::initializeSession() {
@@ -44,100 +75,121 @@ void ChatBridge::setAnthropicApiKey(const QString& k) {
     emit anthropicApiKeyChanged();
 }
 
-void ChatBridge::reset() {
-    // Don't abort - let pending requests finish naturally
-    // They'll be ignored since we're resetting state
-    m_reply = nullptr;
-    m_messages.clear();
-    m_followups.clear();
+Conversation* ChatBridge::conversation(const QString& key) {
+    if (auto* existing = m_conversations.value(key)) return existing;
+
+    auto* conv = new Conversation(key, this, &m_net, &m_passages);
+    m_conversations.insert(key, conv);
+
+    // Only the active conversation drives the QML-facing signals
+    connect(conv, &Conversation::messagesChanged, this, [this, conv](){ if (conv == active()) emit messagesChanged(); });
+    connect(conv, &Conversation::followupsChanged, this, [this, conv](){
+        if (conv == active()) emit followupsChanged();
+        if (!conv->key().startsWith("__")) speculateFollowups(conv);
+    });
+    connect(conv, &Conversation::partialUpdated, this, [this, conv](){ if (conv == active()) emit partialUpdated(); });
+    connect(conv, &Conversation::streamingFinished, this, [this, conv](){ if (conv == active()) emit streamingFinished(); });
+    connect(conv, &Conversation::citationsUpdated, this, [this, conv](const QList<QVariantMap>& cites){
+        if (conv == active()) emit citationsUpdated(cites);
+    });
+    connect(conv, &Conversation::citationsCleared, this, [this, conv](){ if (conv == active()) emit citationsCleared(); });
+    connect(conv, &Conversation::routeSelected, this, [this, conv](const QString& model, const QString& reason){
+        if (conv == active()) emit routeSelected(model, reason);
+    });
+    connect(conv, &Conversation::error, this, [this, conv](const QString& msg){
+        if (conv == active()) emit error(msg);
+        else qDebug() << "ChatBridge: Background conversation" << conv->key() << "error:" << msg;
+    });
+    connect(conv, &Conversation::toolCallRequested, this,
+            [this, conv](const QString& toolName, const QJsonObject& input, const QString& toolId){
+        onToolCallRequested(conv, toolName, input, toolId);
+    });
+    return conv;
+}
+
+Conversation* ChatBridge::active() const {
+    return m_conversations.value(m_activeKey);
+}
+
+void ChatBridge::setActiveConversation(const QString& key) {
+    const QString target = key.isEmpty() ? kDefaultConversation : key;
+    if (m_activeKey == target) return;
+    m_activeKey = target;
+    conversation(m_activeKey);
+    qDebug() << "ChatBridge: Active conversation is now" << m_activeKey;
+    emit activeConversationChanged();
     emit messagesChanged();
     emit followupsChanged();
 }
 
-void ChatBridge::append(const QString& role, const QString& text) {
-    QVariantMap m; m["role"] = role; m["content"] = text;
-    m_messages << m;
-    emit messagesChanged();
+void ChatBridge::closeConversation(const QString& key) {
+    for (int i = m_speculations.size() - 1; i >= 0; --i) {
+        if (m_speculations.at(i).owner == key) dropSpeculation(i);
+    }
+    Conversation* conv = m_conversations.take(key);
+    if (!conv) return;
+    conv->abort();
+    // A closed tab's history goes with it
+    conv->discardJournal();
+    conv->deleteLater();
+    // Keep a (fresh) conversation behind the active key at all times
+    if (key == m_activeKey) {
+        conversation(m_activeKey);
+        emit messagesChanged();
+        emit followupsChanged();
+    }
 }
 
-void ChatBridge::updateLastAssistant(const QString& delta) {
-    if (m_messages.isEmpty()) {
-        qDebug() << "ChatBridge: updateLastAssistant - no messages!";
+void ChatBridge::storeAnswer(const QByteArray& key, const AnswerCache::Entry& entry) {
+    m_answers.store(key, entry);
+    if (m_answers.isDirty()) m_answerSaveTimer.start();
+}
+
+void ChatBridge::refreshAnswer(const QString& userText, const QVariantMap& context) {
+    if (!m_usage->allowsBackgroundWork()) {
+        qDebug() << "ChatBridge: Token budget exceeded, not refreshing" << userText;
         return;
     }
-    auto last = m_messages.last().toMap();
-    if (last.value("role").toString() != "assistant") {
-        qDebug() << "ChatBridge: updateLastAssistant - last message is not assistant, it's" << last.value("role").toString();
+    Conversation* conv = conversation(kRefreshConversation);
+    if (conv->isStreaming()) {
+        qDebug() << "ChatBridge: Answer refresh already running, skipping" << userText;
         return;
     }
-    QString oldContent = last.value("content").toString();
-    QString newContent = oldContent + delta;
-    last["content"] = newContent;
-    m_messages[m_messages.size()-1] = last;
-    qDebug() << "ChatBridge: Updated assistant message, added:" << delta << "Total length:" << newContent.length();
-    // Only emit partialUpdated during streaming to avoid full redraws
-    emit partialUpdated();
+    qDebug() << "ChatBridge: Refreshing cached answer in background:" << userText;
+    conv->reset();
+    conv->refreshAnswer(userText, context);
 }
 
-void ChatBridge::addCitations(const QList<QVariantMap>& cites) {
-    qDebug() << "ChatBridge: addCitations called with" << cites.size() << "citations";
-    for (const auto& cite : cites) {
-        qDebug() << "  Citation:" << cite["title"].toString() << "->" << cite["url"].toString();
+QVariantMap ChatBridge::memoryStats() const {
+    QVariantMap totals;
+    for (const Conversation* conv : m_conversations) {
+        const QVariantMap usage = conv->memoryUsage();
+        for (auto it = usage.cbegin(); it != usage.cend(); ++it)
+            totals[it.key()] = totals.value(it.key()).toLongLong() + it.value().toLongLong();
     }
-    
-    if (m_messages.isEmpty()) return;
-    auto last = m_messages.last().toMap();
-    QVariantList list = last.value("citations").toList();
-    for (const auto& c : cites) list << c;
-    last["citations"] = list;
-    m_messages[m_messages.size()-1] = last;
-    
-    // Store citations for appending to message later
-    m_currentCitations.append(cites);
-    qDebug() << "ChatBridge: Total citations stored:" << m_currentCitations.size();
-    
-    emit messagesChanged();
-    emit citationsUpdated(cites);
+    totals["passageIndex"] = m_passages.approxBytes();
+    totals["answerCache"] = m_answers.approxBytes();
+    return totals;
 }
 
-void ChatBridge::setFollowups(const QList<QVariantMap>& fups) {
-    m_followups = QVariantList::fromList(QList<QVariant>(fups.begin(), fups.end()));
-    emit followupsChanged();
+qint64 ChatBridge::evictColdData() {
+    qint64 freed = m_passages.approxBytes();
+    m_passages.clear();
+    for (Conversation* conv : std::as_const(m_conversations)) {
+        // The visible conversation keeps its messages, only its buffers go
+        const int keep = conv == active() ? -1 : Config::getChatHistoryPage();
+        freed += conv->evictCold(keep);
+    }
+    qDebug() << "ChatBridge: Evicted cold data, ~" << freed / 1024 << "KiB";
+    return freed;
+}
+
+void ChatBridge::reset() {
+    active()->reset();
 }
 
 void ChatBridge::sendMessage(const QString& userText, const QVariantMap& context) {
-    qDebug() << "ChatBridge::sendMessage called with:" << userText;
-    qDebug() << "ChatBridge: Anthropic API key present:" << !m_anthropicApiKey.isEmpty();
-    
-    // Clear citations from previous messages
-    m_currentCitations.clear();
-    
-    if (m_anthropicApiKey.isEmpty()) { 
-        emit error("Anthropic API key not configured"); 
-        return; 
-    }
-    
-    // Make the displayed user message more friendly if it's a follow-up query
-    QString displayText = userText;
-    if (userText.startsWith("Search for statistics about")) {
-        // Convert "Search for statistics about X" to "Ok, searching for statistics on X"
-        QString topic = userText.mid(QString("Search for statistics about").length()).trimmed();
-        if (!topic.isEmpty()) {
-            displayText = QString("Ok, searching for statistics on %1").arg(topic);
-        }
-    } else if (userText.startsWith("Tell me about statistics related to")) {
-        // Convert "Tell me about statistics related to X" to "Ok, searching for statistics on X"  
-        QString topic = userText.mid(QString("Tell me about statistics related to").length()).trimmed();
-        if (!topic.isEmpty()) {
-            displayText = QString("Ok, searching for statistics on %1").arg(topic);
-        }
-    }
-    
-    append("user", displayText);
-    // Don't create assistant message here - it will be created when streaming starts
-    
-    // Call Claude API for chat response (with original text)
-    sendToClaudeAPI(userText, context);
+    active()->sendMessage(userText, context);
 }
 
 void ChatBridge::sendThemeQuery(const QString& theme) {
@@ -145,706 +197,66 @@ void ChatBridge::sendThemeQuery(const QString& theme) {
     sendMessage(query, QVariantMap());
 }
 
-void ChatBridge::sendToClaudeAPI(const QString& userText, const QVariantMap& context) {
-    // Clear citations from previous queries
-    m_currentCitations.clear();
-    
-    // Build messages for Claude
-    QJsonArray messages;
-    for (const auto& v : m_messages) {
-        auto m = v.toMap();
-        QString role = m.value("role").toString();
-        QString content = m.value("content").toString();
-        if (!content.isEmpty() && role != "system") {
-            messages.append(QJsonObject{{"role", role}, {"content", content}});
+void ChatBridge::runFollowupQueue(const QVariantMap& context) {
+    Conversation* conv = active();
+    const QString next = conv->nextFollowup();
+    for (int i = 0; i < m_speculations.size(); ++i) {
+        const Speculation s = m_speculations.at(i);
+        if (s.owner != m_activeKey || s.query != next) continue;
+        m_speculations.removeAt(i);
+        Conversation* spec = m_conversations.value(s.key);
+        // A speculation that failed before answering, or was researched on another page, is not used
+        if (!spec || s.pageUrl != pageUrlOf(context) || (spec->isTurnDone() && spec->messages().size() < 2)) {
+            closeConversation(s.key);
+            break;
         }
+        conv->runFollowupFrom(spec, context);
+        // Keep the hidden conversation until the answer has been copied over
+        if (spec->isTurnDone()) closeConversation(s.key);
+        else connect(spec, &Conversation::turnFinished, this, [this, key = s.key](){ closeConversation(key); });
+        return;
     }
-    
-    // Check if this is a Statista query
-    bool isStatistaQuery = userText.toLower().contains("statist") || 
-                           userText.toLower().contains("data") ||
-                           userText.toLower().contains("tell me about");
-    
-    QString systemPrompt = "You are a research assistant with access to the Statista database integrated into a web browser. "
-        "You help users by providing data-driven, factual answers augmented with statistical evidence.\n\n"
-        "CRITICAL INSTRUCTIONS - Follow this workflow:\n"
-        "1. ANALYZE the user's question to determine what data is needed\n"
-        "2. SEARCH using search-statistics tool for relevant data (this is MANDATORY for any factual question)\n"
-        "3. EVALUATE the search results:\n"
-        "   - If results directly answer the question with sufficient detail → STOP and answer\n"
-        "   - If you need specific numbers/trends from a chart → use get-chart-data-by-id for the TOP 1-2 most relevant results\n"
-        "   - If results are not relevant → try ONE more search with different keywords\n"
-        "4. STOP gathering data once you have enough to answer the question comprehensively\n\n"
-        "IMPORTANT GUIDELINES:\n"
-        "• Do NOT make multiple searches unless the first had no relevant results\n"
-        "• Do NOT fetch chart details for more than 2 charts per query\n"
-        "• Do NOT continue searching if you already have data that answers the question\n"
-        "• The system will automatically display citation buttons for all sources used\n"
-        "• Focus on quality over quantity - better to have 1-2 highly relevant sources than 10 tangential ones\n\n"
-        "Remember: You are a ReAct agent - Reason about what's needed, Act to get it, then STOP when you have enough.";
-    
-    // Define available tools for Claude
-    QJsonArray tools;
-    tools.append(QJsonObject{
-        {"name", "search-statistics"},
-        {"description", "Search Statista database for statistics on a topic. Returns up to 10 results with titles, summaries, and IDs. Use ONCE per query unless first search completely failed. Evaluate results before searching again."},
-        {"input_schema", QJsonObject{
-            {"type", "object"},
-            {"properties", QJsonObject{
-                {"query", QJsonObject{
-                    {"type", "string"},
-                    {"description", "The search query for statistics"}
-                }},
-                {"limit", QJsonObject{
-                    {"type", "integer"},
-                    {"description", "Maximum number of results (default 10)"},
-                    {"default", 10}
-                }}
-            }},
-            {"required", QJsonArray{"query"}}
-        }}
-    });
-    
-    tools.append(QJsonObject{
-        {"name", "get-chart-data-by-id"},
-        {"description", "Get detailed data points and methodology for a specific Statista chart. Use ONLY when search results lack specific numbers you need. Maximum 2 chart fetches per query. Only fetch if the summary doesn't have enough detail."},
-        {"input_schema", QJsonObject{
-            {"type", "object"},
-            {"properties", QJsonObject{
-                {"id", QJsonObject{
-                    {"type", "string"},
-                    {"description", "The Statista chart/statistic ID"}
-                }}
-            }},
-            {"required", QJsonArray{"id"}}
-        }}
-    });
-    
-    QJsonObject payload{
-        {"model", "claude-sonnet-4-20250514"},  // Use Claude Sonnet 4
-        {"system", systemPrompt},
-        {"messages", messages},
-        {"tools", tools},
-        {"max_tokens", 1024},
-        {"temperature", 0.7},
-        {"stream", true}
-    };
-    
-    qDebug() << "ChatBridge: Sending to Claude API";
-    qDebug() << "ChatBridge: Payload:" << QJsonDocument(payload).toJson(QJsonDocument::Compact);
-    
-    QUrl apiUrl("https://api.anthropic.com/v1/messages");
-    qDebug() << "ChatBridge: API URL:" << apiUrl.toString();
-    QNetworkRequest req(apiUrl);
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    req.setRawHeader("x-api-key", m_anthropicApiKey.toUtf8());
-    req.setRawHeader("anthropic-version", "2023-06-01");
-    
-    m_reply = m_net.post(req, QJsonDocument(payload).toJson());
-    m_buffer.clear();
-
-    qDebug() << "ChatBridge: Request sent, waiting for response...";
-
-    // Capture reply as QPointer to safely detect deleted objects
-    QPointer<QNetworkReply> reply = m_reply;
-
-    QObject::connect(m_reply.data(), &QNetworkReply::readyRead, this, [this, reply](){
-        if (reply.isNull()) return;
-        auto data = reply->readAll();
-        qDebug() << "ChatBridge: Received data chunk, size:" << data.size();
-        m_buffer += data;
-        processClaudeStream();
-    });
-
-    QObject::connect(m_reply.data(), &QNetworkReply::finished, this, [this, reply](){
-        if (reply.isNull()) return;
-        qDebug() << "ChatBridge: Request finished";
-        if (reply->error() != QNetworkReply::NoError) {
-            qDebug() << "ChatBridge: Claude API error:" << reply->errorString();
-            qDebug() << "ChatBridge: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-            // Read the error response to see what went wrong
-            auto errorData = reply->readAll();
-            qDebug() << "ChatBridge: Error response size:" << errorData.size();
-            if (!errorData.isEmpty()) {
-                qDebug() << "ChatBridge: Error response body:" << errorData;
-                // Try to parse as JSON for better error message
-                auto doc = QJsonDocument::fromJson(errorData);
-                if (doc.isObject()) {
-                    auto error = doc.object()["error"].toObject();
-                    QString errorType = error["type"].toString();
-                    QString errorMsg = error["message"].toString();
-                    qDebug() << "ChatBridge: API Error Type:" << errorType;
-                    qDebug() << "ChatBridge: API Error Message:" << errorMsg;
-                    // Show error in chat
-                    updateLastAssistant("Error: " + errorMsg);
-                }
-            }
-            emit error(QString("API error: %1").arg(reply->errorString()));
-        } else {
-            // Process any remaining data on successful completion
-            if (!m_buffer.isEmpty()) {
-                processClaudeStream();
-            }
-        }
-        reply->deleteLater();
-    });
+    conv->runFollowupQueue(context);
 }
 
-void ChatBridge::processClaudeStream() {
-    qDebug() << "ChatBridge: Processing stream, buffer size:" << m_buffer.size();
-    
-    // Process Server-Sent Events from Claude
-    while (m_buffer.contains("\n\n")) {
-        int idx = m_buffer.indexOf("\n\n");
-        QByteArray eventBlock = m_buffer.left(idx);
-        m_buffer.remove(0, idx + 2);
-        
-        qDebug() << "ChatBridge: Processing event block:" << eventBlock.left(150);
-        
-        // Parse SSE event - may have multiple lines (event: and data:)
-        QByteArray eventType;
-        QByteArray jsonData;
-        
-        auto lines = eventBlock.split('\n');
-        for (const auto& line : lines) {
-            if (line.startsWith("event: ")) {
-                eventType = line.mid(7);
-            } else if (line.startsWith("data: ")) {
-                jsonData = line.mid(6);
-            }
-        }
-        
-        if (!jsonData.isEmpty()) {
-            if (jsonData == "[DONE]") {
-                qDebug() << "ChatBridge: Stream complete";
-
-                // Append citations to the message if we have any
-                if (!m_currentCitations.isEmpty() && !m_messages.isEmpty()) {
-                    auto last = m_messages.last().toMap();
-                    if (last["role"].toString() == "assistant") {
-                        QString content = last["content"].toString();
-
-                        // Add citations as clickable links at the end
-                        content += "\n\n**Sources:**\n";
-                        for (const auto& cite : m_currentCitations) {
-                            QString title = cite["title"].toString();
-                            QString url = cite["url"].toString();
-                            content += QString("- [%1](%2)\n").arg(title, url);
-                        }
-
-                        last["content"] = content;
-                        m_messages[m_messages.size()-1] = last;
-                        emit messagesChanged();
-                    }
-                }
-
-                emit streamingFinished();
-                emit messagesChanged();
-                continue;
-            }
-            
-            QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-            if (doc.isObject()) {
-                auto obj = doc.object();
-                QString type = obj["type"].toString();
-                qDebug() << "ChatBridge: SSE event type:" << eventType << "JSON type:" << type;
-                
-                // Create assistant message on first content
-                if (type == "message_start") {
-                    // Add empty assistant message to populate
-                    QVariantMap assistantMsg;
-                    assistantMsg["role"] = "assistant";
-                    assistantMsg["content"] = "";
-                    m_messages.append(assistantMsg);
-                    emit messagesChanged();
-                    qDebug() << "ChatBridge: Created assistant message";
-                }
-                
-                if (type == "content_block_delta") {
-                    auto delta = obj["delta"].toObject();
-                    if (delta["type"].toString() == "text_delta") {
-                        QString text = delta["text"].toString();
-                        updateLastAssistant(text);
-                    } else if (delta["type"].toString() == "input_json_delta") {
-                        // Tool use in progress - accumulate the JSON
-                        QString partial = delta["partial_json"].toString();
-                        m_currentToolInput.append(partial);
-                        qDebug() << "ChatBridge: Tool input chunk:" << partial;
-                    }
-                } else if (type == "content_block_start") {
-                    auto contentBlock = obj["content_block"].toObject();
-                    if (contentBlock["type"].toString() == "tool_use") {
-                        QString toolName = contentBlock["name"].toString();
-                        QString toolId = contentBlock["id"].toString();
-                        qDebug() << "ChatBridge: Tool use started:" << toolName << "ID:" << toolId;
-                        m_currentToolName = toolName;
-                        m_currentToolId = toolId;
-                        m_currentToolInput.clear();
-                        
-                        // Add descriptive message about what tool is being used
-                        QString toolMessage;
-                        if (toolName == "search-statistics") {
-                            toolMessage = "\n\n🔍 Searching Statista...\n";
-                        } else if (toolName == "statista.llm.chat.stream") {
-                            toolMessage = "\n\n🔍 Searching Statista database for relevant statistics and data...\n";
-                        } else if (toolName == "statista.llm.search") {
-                            toolMessage = "\n\n🔍 Searching for relevant information...\n";
-                        } else if (toolName == "statista.insights.generate") {
-                            toolMessage = "\n\n📊 Generating insights from the data...\n";
-                        } else if (toolName == "statista.chart.generate") {
-                            toolMessage = "\n\n📈 Creating chart visualization...\n";
-                        } else {
-                            toolMessage = QString("\n\n🔧 Using %1...\n").arg(toolName);
-                        }
-                        updateLastAssistant(toolMessage);
-                    }
-                } else if (type == "content_block_stop") {
-                    // Tool use complete, store details and execute it
-                    if (!m_currentToolName.isEmpty()) {
-                        // Store tool details for later use in sendToolResult
-                        ToolCallDetails details;
-                        details.name = m_currentToolName;
-                        details.input = m_currentToolInput;
-                        m_toolCallDetails[m_currentToolId] = details;
-                        qDebug() << "ChatBridge: Stored tool details for ID:" << m_currentToolId << "Name:" << m_currentToolName;
-                        
-                        executeToolCall(m_currentToolName, m_currentToolId, m_currentToolInput);
-                        m_currentToolName.clear();
-                        m_currentToolId.clear();
-                        m_currentToolInput.clear();
-                    }
-                } else if (type == "message_delta") {
-                    auto delta = obj["delta"].toObject();
-                    if (delta.contains("stop_reason")) {
-                        QString stopReason = delta["stop_reason"].toString();
-                        qDebug() << "ChatBridge: Message stopped with reason:" << stopReason;
-                        
-                        // Citations are now handled via citationsUpdated signal and shown as buttons
-                        // Don't append them as text to the message
-                        // The citations have already been emitted via citationsUpdated signal
-                        if (!m_currentCitations.isEmpty()) {
-                            qDebug() << "ChatBridge: Citations available:" << m_currentCitations.size() << "citations (shown as buttons)";
-                        }
-                        
-                        // Append citations to the message if we have any
-                        if (!m_currentCitations.isEmpty() && !m_messages.isEmpty()) {
-                            auto last = m_messages.last().toMap();
-                            if (last["role"].toString() == "assistant") {
-                                QString content = last["content"].toString();
-                                
-                                // Add citations as clickable links at the end
-                                content += "\n\n**Sources:**\n";
-                                for (const auto& cite : m_currentCitations) {
-                                    QString title = cite["title"].toString();
-                                    QString url = cite["url"].toString();
-                                    content += QString("- [%1](%2)\n").arg(title, url);
-                                }
-                                
-                                last["content"] = content;
-                                m_messages[m_messages.size()-1] = last;
-                                emit messagesChanged();
-                            }
-                        }
-                        
-                        emit streamingFinished();
-                        emit messagesChanged();
-                    }
-                }
-            }
+void ChatBridge::speculateFollowups(Conversation* owner) {
+    // The first few queued follow-ups are answered in hidden conversations at
+    // low priority; optional work, so it stops once the token budget is spent
+    const int count = Config::getFollowupSpeculateCount();
+    QStringList wanted;
+    if (count > 0 && m_usage->allowsBackgroundWork()) {
+        for (const auto& f : owner->followups()) {
+            if (wanted.size() >= count) break;
+            const QString query = f.toMap().value("query").toString();
+            if (!query.isEmpty()) wanted << query;
         }
     }
-}
 
-void ChatBridge::executeToolCall(const QString& toolName, const QString& toolId, const QString& toolInput) {
-    qDebug() << "ChatBridge: Executing tool:" << toolName << "with input:" << toolInput;
-    
-    if (!m_analyzer) {
-        qDebug() << "ChatBridge: No analyzer connected for MCP calls";
-        sendToolResult(toolId, QJsonObject{{"error", "No analyzer connected"}});
-        return;
+    QStringList running;
+    for (int i = m_speculations.size() - 1; i >= 0; --i) {
+        const Speculation& s = m_speculations.at(i);
+        if (s.owner != owner->key()) continue;
+        if (wanted.contains(s.query)) running << s.query;
+        else dropSpeculation(i);
     }
-    
-    QJsonDocument inputDoc = QJsonDocument::fromJson(toolInput.toUtf8());
-    QJsonObject inputObj = inputDoc.object();
-    
-    // Store the tool ID so we can match the response
-    m_pendingToolCalls[toolId] = true;
-    
-    // Delegate to analyzer for MCP calls
-    QMetaObject::invokeMethod(m_analyzer, "executeMCPTool",
-        Q_ARG(QString, toolName),
-        Q_ARG(QJsonObject, inputObj),
-        Q_ARG(QString, toolId));
-}
 
-void ChatBridge::callStatistaMCP(const QString& method, const QJsonObject& params, const QString& toolId) {
-    if (m_endpoint.isEmpty() || m_sessionId.isEmpty()) {
-        qDebug() << "ChatBridge: Cannot call MCP - no endpoint or session";
-        return;
+    const QVariantMap context = owner->lastContext();
+    for (const QString& query : wanted) {
+        if (running.contains(query)) continue;
+        Speculation s{owner->key(), query, pageUrlOf(context), kSpeculationPrefix + QString::number(++m_speculationSerial)};
+        m_speculations.append(s);
+        qDebug() << "ChatBridge: Speculatively answering follow-up" << query << "in" << s.key;
+        // A follow-up answered before comes from the answer cache at no token cost
+        conversation(s.key)->sendMessage(query, context);
     }
-    
-    QJsonObject payload{
-        {"jsonrpc", "2.0"},
-        {"id", QDateTime::currentMSecsSinceEpoch()},
-        {"method", "tools/call"},
-        {"params", QJsonObject{
-            {"name", method},
-            {"arguments", params}
-        }}
-    };
-    
-    QNetworkRequest req(m_endpoint);
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    req.setRawHeader("Accept", "application/json, text/event-stream");
-    req.setRawHeader("x-api-key", m_apiKey.toUtf8());
-    req.setRawHeader("mcp-session-id", m_sessionId.toUtf8());
-    
-    auto* reply = m_net.post(req, QJsonDocument(payload).toJson());
-    
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, toolId, method](){
-        reply->deleteLater();
-        
-        if (reply->error() != QNetworkReply::NoError) {
-            qDebug() << "ChatBridge: MCP call failed:" << reply->errorString();
-            sendToolResult(toolId, QJsonObject{{"error", reply->errorString()}});
-            return;
-        }
-        
-        auto responseData = reply->readAll();
-        
-        // Parse SSE or JSON response
-        QJsonObject result;
-        if (responseData.startsWith("event:") || responseData.contains("\nevent:")) {
-            // Parse SSE
-            auto lines = responseData.split('\n');
-            for (const auto& line : lines) {
-                if (line.startsWith("data: ")) {
-                    auto jsonData = line.mid(6);
-                    auto doc = QJsonDocument::fromJson(jsonData);
-                    if (doc.isObject()) {
-                        result = doc.object();
-                        break;
-                    }
-                }
-            }
-        } else {
-            // Parse JSON
-            auto doc = QJsonDocument::fromJson(responseData);
-            if (doc.isObject()) {
-                result = doc.object();
-            }
-        }
-        
-        // Send result back to Claude
-        if (result.contains("result")) {
-            // Add a completion message to show the tool finished
-            QString completionMsg = "\n✓ Data retrieved successfully. Analyzing results...\n\n";
-            updateLastAssistant(completionMsg);
-            sendToolResult(toolId, result["result"].toObject());
-        } else {
-            updateLastAssistant("\n⚠️ Unable to retrieve data. Let me try another approach...\n\n");
-            sendToolResult(toolId, QJsonObject{{"error", "No result from MCP"}});
-        }
-    });
 }
 
-void ChatBridge::sendToolResult(const QString& toolId, const QJsonObject& result) {
-    qDebug() << "ChatBridge: sendToolResult called for toolId:" << toolId;
-    qDebug() << "ChatBridge: Tool result content length:" << QJsonDocument(result).toJson().length();
-    
-    // Get stored tool details
-    if (!m_toolCallDetails.contains(toolId)) {
-        qDebug() << "ChatBridge: No stored tool details found for toolId:" << toolId;
-        emit error("Internal error: missing tool details");
-        return;
-    }
-    
-    ToolCallDetails toolDetails = m_toolCallDetails.value(toolId);
-    qDebug() << "ChatBridge: Retrieved tool details - Name:" << toolDetails.name << "Input length:" << toolDetails.input.length();
-    
-    // Reconstruct conversation history - include ALL messages to maintain context
-    QJsonArray messages;
-    
-    // Add all previous messages to maintain full context
-    for (const auto& v : m_messages) {
-        auto m = v.toMap();
-        QString role = m.value("role").toString();
-        QString content = m.value("content").toString();
-        
-        // Skip empty assistant messages (these are placeholders for streaming)
-        if (role == "assistant" && content.isEmpty()) {
-            continue;
-        }
-        
-        if (!content.isEmpty()) {
-            messages.append(QJsonObject{{"role", role}, {"content", content}});
-        }
-    }
-    
-    qDebug() << "ChatBridge: Built message history with" << messages.size() << "messages for tool result continuation";
-    
-    // Add assistant message with tool_use (following Python pattern lines 168-172)
-    QJsonArray toolUseContent;
-    QJsonObject toolUseObj;
-    toolUseObj["type"] = "tool_use";
-    toolUseObj["id"] = toolId;
-    toolUseObj["name"] = toolDetails.name;
-    toolUseObj["input"] = QJsonDocument::fromJson(toolDetails.input.toUtf8()).object();
-    toolUseContent.append(toolUseObj);
-    
-    messages.append(QJsonObject{
-        {"role", "assistant"},
-        {"content", toolUseContent}
-    });
-    
-    // Extract actual content from MCP result (result.content[0].text)
-    QString toolResultText;
-    if (result.contains("result") && result["result"].isObject()) {
-        QJsonObject resultObj = result["result"].toObject();
-        if (resultObj.contains("content") && resultObj["content"].isArray()) {
-            QJsonArray contentArray = resultObj["content"].toArray();
-            if (!contentArray.isEmpty() && contentArray[0].isObject()) {
-                QJsonObject firstContent = contentArray[0].toObject();
-                if (firstContent.contains("text")) {
-                    toolResultText = firstContent["text"].toString();
-                    
-                    // Extract citations from Statista tool results
-                    if (toolDetails.name.contains("statista") || toolDetails.name.contains("search-statistics")) {
-                        QJsonDocument textDoc = QJsonDocument::fromJson(toolResultText.toUtf8());
-                        if (textDoc.isObject()) {
-                            QJsonObject textObj = textDoc.object();
-                            if (textObj.contains("items") && textObj["items"].isArray()) {
-                                QJsonArray items = textObj["items"].toArray();
-                                qDebug() << "ChatBridge: Found" << items.size() << "items in Statista result";
-                                
-                                // Extract up to 5 most relevant citations
-                                int citationCount = 0;
-                                for (const auto& item : items) {
-                                    if (citationCount >= 5) break;
-                                    
-                                    QJsonObject itemObj = item.toObject();
-                                    if (itemObj.contains("title") && itemObj.contains("link")) {
-                                        QVariantMap citation;
-                                        citation["title"] = itemObj["title"].toString();
-                                        citation["url"] = itemObj["link"].toString();
-                                        m_currentCitations.append(citation);
-                                        citationCount++;
-                                        qDebug() << "ChatBridge: Added citation:" << citation["title"].toString();
-                                    }
-                                }
-                                qDebug() << "ChatBridge: Extracted" << m_currentCitations.size() << "citations from tool result";
-                                // Citations will be appended to the message text when streaming completes
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    // Fallback if extraction fails
-    if (toolResultText.isEmpty()) {
-        qDebug() << "ChatBridge: Could not extract text from MCP result, using full result as fallback";
-        toolResultText = QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact));
-    }
-    
-    // Add user message with tool_result (following Python pattern lines 174-180)
-    QJsonArray toolResultContent;
-    QJsonObject toolResultObj;
-    toolResultObj["type"] = "tool_result";
-    toolResultObj["tool_use_id"] = toolId;
-    toolResultObj["content"] = toolResultText;
-    toolResultContent.append(toolResultObj);
-    
-    messages.append(QJsonObject{
-        {"role", "user"},
-        {"content", toolResultContent}
-    });
-    
-    // Clean up stored tool details
-    m_toolCallDetails.remove(toolId);
-    
-    // Create payload with tool result and send directly to Claude API
-    QString systemPrompt = "You are a research assistant with access to the Statista database integrated into a web browser. "
-        "You help users by providing data-driven, factual answers augmented with statistical evidence.\n\n"
-        "CRITICAL: You just received tool results. Now EVALUATE:\n"
-        "1. Do you have enough data to comprehensively answer the user's question?\n"
-        "   - YES → Provide your answer now using the data you've gathered\n"
-        "   - NO → Use ONE more tool call (either get-chart-data-by-id for details OR search-statistics with better keywords)\n\n"
-        "STOPPING CRITERIA - You have enough data when:\n"
-        "• The search results contain statistics that directly address the user's question\n"
-        "• You have specific numbers, percentages, or trends relevant to the query\n"
-        "• Additional searches would only provide redundant or tangential information\n\n"
-        "IMPORTANT:\n"
-        "• Maximum 2 searches per user query (unless first search completely failed)\n"
-        "• Maximum 2 chart detail fetches per query\n"
-        "• The system displays citations automatically - don't include links\n"
-        "• If you have relevant data, STOP searching and provide the answer\n\n"
-        "Present your findings clearly and directly answer the user's question with the concrete data you've gathered.";
-    
-    // Define available tools for Claude
-    QJsonArray tools;
-    tools.append(QJsonObject{
-        {"name", "search-statistics"},
-        {"description", "Search Statista database for statistics on a topic. Returns up to 10 results with titles, summaries, and IDs. Use ONCE per query unless first search completely failed. Evaluate results before searching again."},
-        {"input_schema", QJsonObject{
-            {"type", "object"},
-            {"properties", QJsonObject{
-                {"query", QJsonObject{
-                    {"type", "string"},
-                    {"description", "The search query for statistics"}
-                }},
-                {"limit", QJsonObject{
-                    {"type", "integer"},
-                    {"description", "Maximum number of results (default 10)"},
-                    {"default", 10}
-                }}
-            }},
-            {"required", QJsonArray{"query"}}
-        }}
-    });
-    
-    tools.append(QJsonObject{
-        {"name", "get-chart-data-by-id"},
-        {"description", "Get detailed data points and methodology for a specific Statista chart. Use ONLY when search results lack specific numbers you need. Maximum 2 chart fetches per query. Only fetch if the summary doesn't have enough detail."},
-        {"input_schema", QJsonObject{
-            {"type", "object"},
-            {"properties", QJsonObject{
-                {"id", QJsonObject{
-                    {"type", "string"},
-                    {"description", "The Statista chart/statistic ID"}
-                }}
-            }},
-            {"required", QJsonArray{"id"}}
-        }}
-    });
-    
-    QJsonObject payload{
-        {"model", "claude-sonnet-4-20250514"},
-        {"max_tokens", 1024},
-        {"temperature", 0.7},
-        {"system", systemPrompt},
-        {"messages", messages},
-        {"tools", tools},
-        {"stream", true}
-    };
-    
-    qDebug() << "ChatBridge: Continuing with tool result, sending to Claude API";
-    qDebug() << "ChatBridge: Payload summary - messages count:" << messages.size() << "model:" << payload["model"].toString();
-    qDebug() << "ChatBridge: Full payload being sent to Claude API:" << QJsonDocument(payload).toJson(QJsonDocument::Compact).left(1000) + "...";
-    postToClaudeAPI(payload);
+void ChatBridge::dropSpeculation(int index) {
+    const QString key = m_speculations.takeAt(index).key;
+    qDebug() << "ChatBridge: Dropping speculative follow-up" << key;
+    closeConversation(key);
 }
 
-void ChatBridge::runFollowupQueue(const QVariantMap& context) {
-    // Consume m_followups FIFO; for brevity just send the first and pop.
-    if (m_followups.isEmpty()) return;
-    auto f = m_followups.first().toMap();
-    m_followups.removeFirst();
-    emit followupsChanged();
-    sendMessage(f.value("query").toString(), context);
-}
-
-void ChatBridge::postStream(const QJsonObject& payload) {
-    // Don't abort old requests - let them finish naturally
-    // Just clear our reference to allow new request
-    m_reply = nullptr;
-    
-    qDebug() << "ChatBridge: Posting to" << m_endpoint;
-    qDebug() << "ChatBridge: API key present:" << !m_apiKey.isEmpty();
-    qDebug() << "ChatBridge: Session ID:" << m_sessionId;
-    
-    QNetworkRequest req(m_endpoint);
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    req.setRawHeader("Accept", "application/x-ndjson, text/event-stream, application/json");
-    if (!m_apiKey.isEmpty()) req.setRawHeader("x-api-key", m_apiKey.toUtf8());
-    // Only send session ID if we have one (after initialization)
-    if (!m_sessionId.isEmpty()) {
-        req.setRawHeader("mcp-session-id", m_sessionId.toUtf8());
-    }
-    
-    // Enable redirect following (Qt6)
-    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-
-    m_reply = m_net.post(req, QJsonDocument(payload).toJson());
-
-    // Capture reply as QPointer to safely detect deleted objects
-    QPointer<QNetworkReply> reply = m_reply;
-
-    // Extract session ID from response headers if present (for streaming responses)
-    QObject::connect(m_reply.data(), &QNetworkReply::metaDataChanged, this, [this, reply](){
-        if (reply.isNull()) return;
-        if (!m_sessionInitialized && reply->hasRawHeader("mcp-session-id")) {
-            m_sessionId = QString::fromUtf8(reply->rawHeader("mcp-session-id"));
-            qDebug() << "ChatBridge: Got session ID from server:" << m_sessionId;
-        }
-    });
-
-    QObject::connect(m_reply.data(), &QNetworkReply::readyRead, this, [this, reply](){
-        if (reply.isNull()) return;
-        m_buffer += reply->readAll();
-        qDebug() << "ChatBridge: Received data chunk, buffer size:" << m_buffer.size();
-        
-        // Parse NDJSON lines; each line is a JSON object like:
-        // {"type":"delta","text":"..."}
-        // {"type":"citation","title":"...","url":"..."}
-        // {"type":"followups","items":[{"query":"..."}, ...]}
-        int idx;
-        while ((idx = m_buffer.indexOf('\n')) != -1) {
-            QByteArray line = m_buffer.left(idx).trimmed();
-            m_buffer.remove(0, idx+1);
-            if (line.isEmpty()) continue;
-            
-            qDebug() << "ChatBridge: Processing line:" << line.left(100);
-            
-            QJsonParseError err; auto doc = QJsonDocument::fromJson(line, &err);
-            if (err.error != QJsonParseError::NoError || !doc.isObject()) {
-                qDebug() << "ChatBridge: JSON parse error:" << err.errorString();
-                continue;
-            }
-            auto obj = doc.object();
-            QString type = obj.value("type").toString();
-            if (type == "delta") {
-                updateLastAssistant(obj.value("text").toString());
-            } else if (type == "citation") {
-                QList<QVariantMap> cites;
-                QVariantMap c;
-                c["title"] = obj.value("title").toString();
-                c["url"] = obj.value("url").toString();
-                cites << c;
-                addCitations(cites);
-            } else if (type == "followups") {
-                QList<QVariantMap> fups;
-                for (const auto& v : obj.value("items").toArray()) {
-                    QVariantMap m;
-                    auto o = v.toObject();
-                    m["query"] = o.value("query").toString();
-                    fups << m;
-                }
-                setFollowups(fups);
-            }
-        }
-    });
-    QObject::connect(m_reply.data(), &QNetworkReply::finished, this, [this, reply](){
-        if (reply.isNull()) return;
-        if (reply->error() != QNetworkReply::NoError) {
-            qDebug() << "ChatBridge: Network error:" << reply->error() << reply->errorString();
-            qDebug() << "ChatBridge: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-
-            // Try to read any error response from Claude API
-            auto errorData = reply->readAll();
-            if (!errorData.isEmpty()) {
-                qDebug() << "ChatBridge: Claude API error response (first 1000 chars):" << errorData.left(1000);
-                qDebug() << "ChatBridge: Full error response length:" << errorData.length();
-            } else {
-                qDebug() << "ChatBridge: No error response body from Claude API";
-            }
-
-            emit error(QString("Network error: %1").arg(reply->errorString()));
-        }
-        reply->deleteLater();
-    });
-}
 void ChatBridge::setAnalyzer(QObject* analyzer) {
     if (m_analyzer) {
         // Disconnect old analyzer
@@ -860,120 +272,26 @@ void ChatBridge::setAnalyzer(QObject* analyzer) {
     }
 }
 
-void ChatBridge::onToolResult(const QString& requestId, const QJsonObject& result) {
-    qDebug() << "ChatBridge: onToolResult called with requestId:" << requestId;
-    qDebug() << "ChatBridge: Pending tool calls:" << m_pendingToolCalls.keys();
-    qDebug() << "ChatBridge: Tool result:" << QJsonDocument(result).toJson(QJsonDocument::Compact);
-    
-    // Extract citations from Statista tool results
-    // The structure is: result -> content -> [array of items with text field containing JSON string]
-    if (result.contains("result")) {
-        auto resultObj = result["result"].toObject();
-        if (resultObj.contains("content")) {
-            auto contentArr = resultObj["content"].toArray();
-            QList<QVariantMap> citations;
-            
-            for (const auto& item : contentArr) {
-                auto itemObj = item.toObject();
-                qDebug() << "ChatBridge: Content item keys:" << itemObj.keys();
-                
-                if (itemObj.contains("text")) {
-                    QJsonObject textObj;
-                    
-                    // Check if text is already an object (not a string)
-                    if (itemObj["text"].isObject()) {
-                        textObj = itemObj["text"].toObject();
-                        qDebug() << "ChatBridge: Text is already an object with keys:" << textObj.keys();
-                    } else if (itemObj["text"].isString()) {
-                        // The text field contains a JSON string that needs to be parsed
-                        QString textStr = itemObj["text"].toString();
-                        qDebug() << "ChatBridge: Parsing text string:" << textStr.left(200);
-                        QJsonDocument textDoc = QJsonDocument::fromJson(textStr.toUtf8());
-                        if (textDoc.isObject()) {
-                            textObj = textDoc.object();
-                            qDebug() << "ChatBridge: Parsed text object keys:" << textObj.keys();
-                        }
-                    }
-                    
-                    if (!textObj.isEmpty()) {
-                        // Check for direct title and link in the object
-                        if (textObj.contains("title") && textObj.contains("link")) {
-                            QVariantMap cite;
-                            cite["title"] = textObj["title"].toString();
-                            cite["url"] = textObj["link"].toString();
-                            citations << cite;
-                            qDebug() << "ChatBridge: Found citation from chart data:" << cite["title"].toString() << "->" << cite["url"].toString();
-                        }
-                        
-                        // Also check for statistics array
-                        if (textObj.contains("statistics")) {
-                            auto statsArr = textObj["statistics"].toArray();
-                            for (const auto& stat : statsArr) {
-                                auto statObj = stat.toObject();
-                                if (statObj.contains("title") && statObj.contains("link")) {
-                                    QVariantMap cite;
-                                    cite["title"] = statObj["title"].toString();
-                                    cite["url"] = statObj["link"].toString();
-                                    citations << cite;
-                                    qDebug() << "ChatBridge: Found citation from statistics:" << cite["title"].toString() << "->" << cite["url"].toString();
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-            
-            if (!citations.isEmpty()) {
-                addCitations(citations);
-            }
-        }
-    }
-    
-    if (m_pendingToolCalls.contains(requestId)) {
-        m_pendingToolCalls.remove(requestId);
-        sendToolResult(requestId, result);
-    } else {
-        qDebug() << "ChatBridge: No pending tool call found for requestId:" << requestId;
+void ChatBridge::onToolCallRequested(Conversation* conv, const QString& toolName, const QJsonObject& input, const QString& toolId) {
+    if (!m_analyzer) {
+        qDebug() << "ChatBridge: No analyzer connected for MCP calls";
+        conv->handleToolResult(toolId, QJsonObject{{"error", "No analyzer connected"}});
+        return;
     }
-}
 
-void ChatBridge::postToClaudeAPI(const QJsonObject& payload) {
-    // Don't abort old requests - let them finish naturally
-    // Just clear our reference to allow new request
-    m_reply = nullptr;
+    m_toolOwners.insert(toolId, conv);
+    // Delegate to analyzer for MCP calls
+    QMetaObject::invokeMethod(m_analyzer, "executeMCPTool",
+        Q_ARG(QString, toolName),
+        Q_ARG(QJsonObject, input),
+        Q_ARG(QString, toolId));
+}
 
-    QString claudeEndpoint = "https://api.anthropic.com/v1/messages";
-    qDebug() << "ChatBridge: API URL:" << claudeEndpoint;
-    qDebug() << "ChatBridge: Anthropic API key present:" << !m_anthropicApiKey.isEmpty();
-    
-    QNetworkRequest req(claudeEndpoint);
-    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    req.setRawHeader("accept", "text/event-stream");
-    req.setRawHeader("anthropic-version", "2023-06-01");
-    if (!m_anthropicApiKey.isEmpty()) {
-        req.setRawHeader("x-api-key", m_anthropicApiKey.toUtf8());
+void ChatBridge::onToolResult(const QString& requestId, const QJsonObject& result) {
+    QPointer<Conversation> owner = m_toolOwners.take(requestId);
+    if (!owner) {
+        qDebug() << "ChatBridge: No conversation waiting for tool result" << requestId;
+        return;
     }
-    
-    qDebug() << "ChatBridge: Request sent, waiting for response...";
-    m_reply = m_net.post(req, QJsonDocument(payload).toJson());
-
-    // Capture reply as QPointer to safely detect deleted objects
-    QPointer<QNetworkReply> reply = m_reply;
-    QObject::connect(m_reply.data(), &QNetworkReply::readyRead, this, [this, reply](){
-        if (reply.isNull()) return;
-        m_buffer += reply->readAll();
-        qDebug() << "ChatBridge: Received data chunk, size:" << m_buffer.size();
-
-        processClaudeStream();
-    });
-
-    QObject::connect(m_reply.data(), &QNetworkReply::finished, this, [this, reply](){
-        if (reply.isNull()) return;
-        qDebug() << "ChatBridge: Request finished";
-        if (reply->error() != QNetworkReply::NoError) {
-            qDebug() << "ChatBridge: Network error:" << reply->error() << reply->errorString();
-            qDebug() << "ChatBridge: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        }
-        processClaudeStream();
-    });
+    owner->handleToolResult(requestId, result);
 }
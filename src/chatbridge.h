@@ -4,19 +4,34 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPointer>
+#include <QHash>
+#include <QTimer>
+#include "conversation.h"
+#include "passageretriever.h"
+#include "modelrouter.h"
+#include "toolregistry.h"
+#include "toolresultreducer.h"
+#include "answercache.h"
+#include "usageledger.h"
 
 // Streaming ChatBridge: supports incremental tokens, citations with "open in new tab",
-// and a queue of follow-up queries.
+// and a queue of follow-up queries. Holds one Conversation per tab (keyed by the
+// tab's key); the properties and signals reflect the active conversation while
+// the others keep streaming in the background.
 class ChatBridge : public QObject {
     Q_OBJECT
     Q_PROPERTY(QString endpoint READ endpoint WRITE setEndpoint NOTIFY endpointChanged)
     Q_PROPERTY(QString apiKey READ apiKey WRITE setApiKey NOTIFY apiKeyChanged)
     Q_PROPERTY(QString anthropicApiKey READ anthropicApiKey WRITE setAnthropicApiKey NOTIFY anthropicApiKeyChanged)
+    Q_PROPERTY(QString activeConversation READ activeConversation WRITE setActiveConversation NOTIFY activeConversationChanged)
     Q_PROPERTY(QVariantList messages READ messages NOTIFY messagesChanged)
     Q_PROPERTY(QVariantList followups READ followups NOTIFY followupsChanged)
+    Q_PROPERTY(bool hasOlderMessages READ hasOlderMessages NOTIFY messagesChanged)
+    Q_PROPERTY(QObject* streamingDocument READ streamingDocument NOTIFY activeConversationChanged)
 
 public:
     explicit ChatBridge(QObject* parent=nullptr);
+    ~ChatBridge() override;
 
     QString endpoint() const { return m_endpoint; }
     void setEndpoint(const QString& e);
@@ -24,9 +39,13 @@ public:
     void setApiKey(const QString& k);
     QString anthropicApiKey() const { return m_anthropicApiKey; }
     void setAnthropicApiKey(const QString& k);
+    QString activeConversation() const { return m_activeKey; }
+    void setActiveConversation(const QString& key);
 
-    QVariantList messages() const { return m_messages; }
-    QVariantList followups() const { return m_followups; }
+    QVariantList messages() const { return active()->messages(); }
+    QVariantList followups() const { return active()->followups(); }
+    QObject* streamingDocument() const { return active()->streamingDocument(); }
+    bool hasOlderMessages() const { return active()->hasOlderMessages(); }
 
     Q_INVOKABLE void initializeSession();
     Q_INVOKABLE void reset();
@@ -34,60 +53,88 @@ public:
     Q_INVOKABLE void sendThemeQuery(const QString& theme);
     Q_INVOKABLE void runFollowupQueue(const QVariantMap& context);
     Q_INVOKABLE void setAnalyzer(QObject* analyzer);
+    void setToolRegistry(ToolRegistry* registry) { m_tools = registry ? registry : &m_builtinTools; }
+    void setUsageLedger(UsageLedger* usage) { m_usage = usage ? usage : &m_ownUsage; }
+    Q_INVOKABLE bool isStreaming() const { return active()->isStreaming(); }
+    Q_INVOKABLE void closeConversation(const QString& key);
+    // Page older messages of the active conversation in from disk
+    Q_INVOKABLE int loadOlderMessages(int count) { return active()->loadOlder(count); }
+    Q_INVOKABLE QVariantMap modelStats() const { return m_router.stats(); }
+    Q_INVOKABLE QVariantMap toolResultStats() const { return m_reducer.stats(); }
+    // Approximate bytes held by conversations and the shared caches
+    Q_INVOKABLE QVariantMap memoryStats() const;
+    // Drop cold conversation data and rebuildable caches; returns approximate bytes freed
+    Q_INVOKABLE qint64 evictColdData();
+
+    ModelRouter* router() { return &m_router; }
+    const ToolRegistry* tools() const { return m_tools; }
+    ToolResultReducer* resultReducer() { return &m_reducer; }
+    UsageLedger* usage() { return m_usage; }
+    bool lookupAnswer(const QByteArray& key, AnswerCache::Entry* out) const { return m_answers.lookup(key, out); }
+    void storeAnswer(const QByteArray& key, const AnswerCache::Entry& entry);
+    // Re-run a question whose answer was replayed from cache, off screen
+    void refreshAnswer(const QString& userText, const QVariantMap& context);
 
 signals:
     void endpointChanged();
     void apiKeyChanged();
     void anthropicApiKeyChanged();
+    void activeConversationChanged();
     void messagesChanged();
     void followupsChanged();
     void error(const QString& msg);
     void partialUpdated(); // emitted when the last assistant message receives new tokens
     void streamingFinished(); // emitted when streaming is complete
     void citationsUpdated(const QList<QVariantMap>& cites); // emitted when citations are updated
+    void citationsCleared(); // emitted when a new turn drops the previous citations
+    void routeSelected(const QString& model, const QString& reason); // model chosen for the active turn
 
 private slots:
     void onToolResult(const QString& requestId, const QJsonObject& result);
 
 private:
-    void append(const QString& role, const QString& text);
-    void updateLastAssistant(const QString& delta);
-    void addCitations(const QList<QVariantMap>& cites);
-    void setFollowups(const QList<QVariantMap>& fups);
-    void postStream(const QJsonObject& payload);
-    void sendToClaudeAPI(const QString& userText, const QVariantMap& context);
-    void processClaudeStream();
-    void executeToolCall(const QString& toolName, const QString& toolId, const QString& toolInput);
-    void callStatistaMCP(const QString& method, const QJsonObject& params, const QString& toolId);
-    void sendToolResult(const QString& toolId, const QJsonObject& result);
-    void postToClaudeAPI(const QJsonObject& payload);
+    Conversation* conversation(const QString& key);
+    Conversation* active() const;
+    void onToolCallRequested(Conversation* conv, const QString& toolName, const QJsonObject& input, const QString& toolId);
+    void speculateFollowups(Conversation* owner);
+    void dropSpeculation(int index);
 
     QNetworkAccessManager m_net;
     QString m_endpoint;
     QString m_apiKey;
     QString m_anthropicApiKey;
-    QString m_sessionId;
     bool m_sessionInitialized{false};
 
-    QVariantList m_messages;
-    QVariantList m_followups;
-    QList<QVariantMap> m_currentCitations;
-    QByteArray m_buffer;
-    QPointer<QNetworkReply> m_reply;
-    
-    // Tool use tracking
-    QString m_currentToolName;
-    QString m_currentToolId;
-    QString m_currentToolInput;
-    
-    // Store tool call details by tool ID for later use in sendToolResult
-    struct ToolCallDetails {
-        QString name;
-        QString input;
+    // Conversations by tab key; the active one backs the QML-facing properties
+    QHash<QString, Conversation*> m_conversations;
+    QString m_activeKey;
+    // Chunked page indexes are shared so tabs on the same page reuse them
+    PassageRetriever m_passages;
+    // Shared so latency measurements from every tab inform routing
+    ModelRouter m_router;
+    // Tools offered to Claude; the built-in set is used until a shared registry is set
+    ToolRegistry m_builtinTools;
+    ToolRegistry* m_tools{&m_builtinTools};
+    // Shared so savings are totalled across tabs
+    ToolResultReducer m_reducer;
+    // Token accounting; a private ledger is used until the shared one is set
+    UsageLedger m_ownUsage;
+    UsageLedger* m_usage{&m_ownUsage};
+    // Shared so tabs and sessions reuse each other's answers
+    AnswerCache m_answers;
+    QTimer m_answerSaveTimer;
+
+    // Follow-ups answered ahead of the user's click in hidden conversations
+    struct Speculation {
+        QString owner;   // conversation the follow-up belongs to
+        QString query;
+        QString pageUrl; // page it was researched on; another page means a different answer
+        QString key;     // hidden conversation running it
     };
-    QHash<QString, ToolCallDetails> m_toolCallDetails;
-    
-    // Analyzer reference for MCP calls
+    QList<Speculation> m_speculations;
+    int m_speculationSerial{0};
+
+    // Analyzer reference for MCP calls, and which conversation issued each tool call
     QObject* m_analyzer{nullptr};
-    QHash<QString, bool> m_pendingToolCalls;
-};
\ No newline at end of file
+    QHash<QString, QPointer<Conversation>> m_toolOwners;
+};
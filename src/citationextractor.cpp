@@ -0,0 +1,66 @@
+#include "citationextractor.h"
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QRegularExpression>
+
+namespace {
+// Search results are ranked, so only the top few are worth citing
+constexpr int kMaxItemCitations = 5;
+}
+
+QString CitationExtractor::canonicalKey(const QVariantMap& cite) {
+    const QString id = cite.value("id").toString();
+    if (!id.isEmpty()) return "id:" + id;
+
+    QUrl url(cite.value("url").toString().trimmed());
+    if (!url.isValid() || url.isEmpty()) return QString();
+    static const QRegularExpression statisticId("/statistics?/(\\d+)(/|$)");
+    const auto m = statisticId.match(url.path());
+    if (m.hasMatch()) return "id:" + m.captured(1);
+
+    url.setFragment(QString());
+    url.setScheme(url.scheme().toLower());
+    url.setHost(url.host().toLower());
+    QUrlQuery query(url);
+    for (const auto& item : query.queryItems()) {
+        if (item.first.startsWith("utm_")) query.removeAllQueryItems(item.first);
+    }
+    url.setQuery(query);
+    QString key = url.toString(QUrl::NormalizePathSegments);
+    if (key.endsWith('/')) key.chop(1);
+    return key;
+}
+
+QList<QVariantMap> CitationExtractor::extract(const QJsonValue& parsed) {
+    QList<QVariantMap> out;
+    const QJsonObject obj = parsed.toObject();
+    if (obj.isEmpty()) return out;
+
+    auto add = [&out](const QJsonObject& o) {
+        if (!o.contains("title") || !o.contains("link")) return false;
+        out << QVariantMap{{"title", o.value("title").toString()}, {"url", o.value("link").toString()}};
+        return true;
+    };
+    // Chart data: the result itself is the source
+    add(obj);
+    for (const auto& stat : obj.value("statistics").toArray()) add(stat.toObject());
+    int taken = 0;
+    for (const auto& item : obj.value("items").toArray()) {
+        if (taken >= kMaxItemCitations) break;
+        if (add(item.toObject())) ++taken;
+    }
+    return out;
+}
+
+QList<QVariantMap> CitationExtractor::filterNew(const QList<QVariantMap>& cites) {
+    QList<QVariantMap> out;
+    for (const auto& c : cites) {
+        const QString key = canonicalKey(c);
+        if (key.isEmpty() || m_seen.contains(key)) continue;
+        m_seen.insert(key);
+        out << c;
+    }
+    return out;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <QString>
+#include <QSet>
+#include <QList>
+#include <QVariantMap>
+#include <QJsonValue>
+
+// Pulls source citations out of a parsed MCP tool result in one pass (a
+// top-level title/link, "statistics" and "items" lists), and remembers which
+// sources a turn has already cited, keyed by statistic id or canonical URL.
+class CitationExtractor {
+public:
+    // Citations in the parsed text of one tool result
+    static QList<QVariantMap> extract(const QJsonValue& parsed);
+
+    // Keep only citations not seen yet this turn (from any source) and remember them
+    QList<QVariantMap> filterNew(const QList<QVariantMap>& cites);
+    void reset() { m_seen.clear(); }
+
+    // Statistic id for Statista links, otherwise the URL without fragment,
+    // tracking parameters and trailing slash
+    static QString canonicalKey(const QVariantMap& cite);
+
+private:
+    QSet<QString> m_seen;
+};
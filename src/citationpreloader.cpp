@@ -0,0 +1,131 @@
+#include "citationpreloader.h"
+#include <QNetworkInformation>
+#include <QUrl>
+#include <QDebug>
+#include "tablifecycle.h"
+#include "config.h"
+
+CitationPreloader::CitationPreloader(QObject* parent) : QObject(parent),
+    m_topK(Config::getPreloadTopK()),
+    m_maxConcurrent(qMax(1, Config::getPreloadMaxConcurrent())),
+    m_memoryMb(Config::getPreloadMemoryMb()),
+    m_viewMb(qMax(1, Config::getTabEstimatedMb())) {
+    if (QNetworkInformation::loadBackendByFeatures(QNetworkInformation::Feature::Metered)) {
+        connect(QNetworkInformation::instance(), &QNetworkInformation::isMeteredChanged, this, [this](bool metered){
+            qDebug() << "CitationPreloader: Connection is" << (metered ? "metered, preloading off" : "unmetered");
+            if (metered) clear();
+            emit enabledChanged();
+        });
+    }
+}
+
+bool CitationPreloader::isMetered() const {
+    const QNetworkInformation* info = QNetworkInformation::instance();
+    return info && info->supports(QNetworkInformation::Feature::Metered) && info->isMetered();
+}
+
+bool CitationPreloader::isEnabled() const {
+    return m_topK > 0 && !isMetered();
+}
+
+QString CitationPreloader::normalizeUrl(const QString& url) {
+    QUrl u(url);
+    u.setFragment(QString());
+    return u.adjusted(QUrl::StripTrailingSlash | QUrl::NormalizePathSegments).toString();
+}
+
+int CitationPreloader::capacity() const {
+    if (!isEnabled()) return 0;
+    int views = qMin(m_topK, m_memoryMb / m_viewMb);
+    if (m_tabs) {
+        // Hidden views count against the same budget as the open tabs
+        const QVariantMap tabs = m_tabs->stats();
+        const int headroomMb = tabs.value("budgetMb").toInt() - tabs.value("estimatedMb").toInt();
+        views = qMin(views, headroomMb / m_viewMb);
+    }
+    return qMax(0, views);
+}
+
+void CitationPreloader::addCitations(const QList<QVariantMap>& cites) {
+    const int cap = capacity();
+    for (const auto& c : cites) {
+        if (m_entries.size() >= cap) break;
+        const QString url = normalizeUrl(c.value("url").toString());
+        const QString scheme = QUrl(url).scheme();
+        if (scheme != "https" && scheme != "http") continue;
+        bool known = false;
+        for (const Entry& e : m_entries) known = known || e.url == url;
+        if (!known) m_entries.append(Entry{url});
+    }
+    pump();
+}
+
+void CitationPreloader::pump() {
+    int loading = 0;
+    for (const Entry& e : m_entries) {
+        if (e.state == State::Loading) ++loading;
+    }
+    for (Entry& e : m_entries) {
+        if (loading >= m_maxConcurrent) break;
+        if (e.state != State::Queued) continue;
+        e.state = State::Loading;
+        ++loading;
+        qDebug() << "CitationPreloader: Preloading" << e.url;
+        emit preloadRequested(e.url);
+    }
+}
+
+void CitationPreloader::release(int index) {
+    const Entry e = m_entries.takeAt(index);
+    if (e.state == State::Ready) ++m_wasted;
+    if (e.state != State::Queued) emit releaseRequested(e.url);
+}
+
+void CitationPreloader::clear() {
+    while (!m_entries.isEmpty()) release(m_entries.size() - 1);
+}
+
+void CitationPreloader::loadFinished(const QString& url, bool ok) {
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).url != url || m_entries.at(i).state != State::Loading) continue;
+        if (ok) {
+            m_entries[i].state = State::Ready;
+        } else {
+            qDebug() << "CitationPreloader: Preload failed for" << url;
+            release(i);
+        }
+        break;
+    }
+    pump();
+}
+
+QString CitationPreloader::take(const QString& url) {
+    const QString key = normalizeUrl(url);
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).url != key) continue;
+        const State state = m_entries.takeAt(i).state;
+        pump();
+        // A view still loading is adopted too; it is already ahead of a cold tab
+        if (state == State::Queued) break;
+        ++m_hits;
+        return key;
+    }
+    ++m_misses;
+    return QString();
+}
+
+QVariantMap CitationPreloader::stats() const {
+    int ready = 0;
+    for (const Entry& e : m_entries) {
+        if (e.state == State::Ready) ++ready;
+    }
+    return {
+        {"enabled", isEnabled()},
+        {"pooled", m_entries.size()},
+        {"ready", ready},
+        {"capacity", capacity()},
+        {"hits", m_hits},
+        {"misses", m_misses},
+        {"wasted", m_wasted}
+    };
+}
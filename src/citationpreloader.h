@@ -0,0 +1,60 @@
+#pragma once
+#include <QObject>
+#include <QList>
+#include <QVariantMap>
+
+class TabLifecycle;
+
+// Picks which cited pages of the current answer to load ahead of a click.
+// QML keeps the hidden WebEngineViews (created on preloadRequested, destroyed
+// on releaseRequested) and adopts one as a real tab when take() says it has
+// it. The pool is capped by count, concurrent loads and memory headroom next
+// to the open tabs, and stays empty on metered connections.
+class CitationPreloader : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled NOTIFY enabledChanged)
+public:
+    explicit CitationPreloader(QObject* parent=nullptr);
+
+    void setTabLifecycle(TabLifecycle* tabs) { m_tabs = tabs; }
+    bool isEnabled() const;
+
+    // Citations as they stream in, most relevant first
+    void addCitations(const QList<QVariantMap>& cites);
+    // A new answer started or the conversation changed; drops the pool
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE void loadFinished(const QString& url, bool ok);
+    // The user opened url; returns the url of the preloaded view QML should
+    // adopt for it (as passed to preloadRequested), or empty if there is none
+    Q_INVOKABLE QString take(const QString& url);
+    Q_INVOKABLE QVariantMap stats() const;
+
+    static QString normalizeUrl(const QString& url);
+
+signals:
+    void preloadRequested(const QString& url);
+    void releaseRequested(const QString& url);
+    void enabledChanged();
+
+private:
+    enum class State { Queued, Loading, Ready };
+    struct Entry {
+        QString url;
+        State state{State::Queued};
+    };
+
+    int capacity() const;
+    bool isMetered() const;
+    void pump();
+    void release(int index);
+
+    TabLifecycle* m_tabs{nullptr};
+    QList<Entry> m_entries; // in citation order
+    int m_topK;
+    int m_maxConcurrent;
+    int m_memoryMb;
+    int m_viewMb;
+    int m_hits{0};
+    int m_misses{0};
+    int m_wasted{0}; // loaded but released without being opened
+};
@@ -41,6 +41,78 @@ namespace Config {
     inline QString getAnthropicApiKey() {
         return getConfigValue("ANTHROPIC_API_KEY", DEFAULT_ANTHROPIC_API_KEY);
     }
+
+    // Integer settings fall back to the default when unset or not a number
+    inline int getConfigInt(const QString& envVar, int defaultValue) {
+        bool ok = false;
+        int value = getConfigValue(envVar, QString()).toInt(&ok);
+        return ok ? value : defaultValue;
+    }
+
+    // MCP tool call resilience (timeouts in milliseconds)
+    inline int getMcpMaxRetries() { return getConfigInt("MCP_MAX_RETRIES", 2); }
+    inline int getMcpMinTimeoutMs() { return getConfigInt("MCP_MIN_TIMEOUT_MS", 4000); }
+    inline int getMcpMaxTimeoutMs() { return getConfigInt("MCP_MAX_TIMEOUT_MS", 30000); }
+    inline int getMcpBreakerThreshold() { return getConfigInt("MCP_BREAKER_THRESHOLD", 5); }
+    inline int getMcpBreakerCooldownMs() { return getConfigInt("MCP_BREAKER_COOLDOWN_MS", 30000); }
+
+    // Theme extraction jobs from several tabs are collected for this long and sent as one request
+    inline int getThemeBatchWindowMs() { return getConfigInt("THEME_BATCH_WINDOW_MS", 400); }
+    inline int getThemeBatchMaxDocs() { return getConfigInt("THEME_BATCH_MAX_DOCS", 6); }
+
+    // Theme extraction backends (THEME_BACKEND, THEME_LOCAL_* are read in themebackend.cpp)
+    inline int getThemeLocalTimeoutMs() { return getConfigInt("THEME_LOCAL_TIMEOUT_MS", 5000); }
+    inline int getThemeRemoteTimeoutMs() { return getConfigInt("THEME_REMOTE_TIMEOUT_MS", 15000); }
+
+    // Page passages added to chat requests
+    inline int getPageContextTokenBudget() { return getConfigInt("PAGE_CONTEXT_TOKEN_BUDGET", 800); }
+    inline int getPageContextTopK() { return getConfigInt("PAGE_CONTEXT_TOP_K", 4); }
+
+    // Chat model routing; ANSWER_MODEL pins every turn to one model
+    inline QString getFastModel() { return getConfigValue("ANSWER_FAST_MODEL", "claude-3-5-haiku-20241022"); }
+    inline QString getStrongModel() { return getConfigValue("ANSWER_STRONG_MODEL", "claude-sonnet-4-20250514"); }
+    inline QString getModelOverride() { return getConfigValue("ANSWER_MODEL", QString()); }
+
+    // Tool output reduction before it goes back to Claude
+    inline bool getToolResultReduce() { return getConfigInt("TOOL_RESULT_REDUCE", 1) != 0; }
+    inline int getToolResultMaxItems() { return getConfigInt("TOOL_RESULT_MAX_ITEMS", 8); }
+    inline int getToolResultMaxString() { return getConfigInt("TOOL_RESULT_MAX_STRING", 300); }
+
+    // Per-turn ReAct budget
+    inline int getTurnMaxToolCalls() { return getConfigInt("TURN_MAX_TOOL_CALLS", 4); }
+    inline int getTurnMaxRoundTrips() { return getConfigInt("TURN_MAX_ROUND_TRIPS", 5); }
+    inline int getTurnMaxSeconds() { return getConfigInt("TURN_MAX_SECONDS", 45); }
+    inline int getTurnMaxSearches() { return getConfigInt("TURN_MAX_SEARCHES", 2); }
+    inline int getTurnMaxChartFetches() { return getConfigInt("TURN_MAX_CHART_FETCHES", 2); }
+
+    // Whole-answer cache; a TTL of 0 disables it
+    inline int getAnswerCacheTtlHours() { return getConfigInt("ANSWER_CACHE_TTL_HOURS", 24); }
+    inline bool getAnswerCacheRefresh() { return getConfigInt("ANSWER_CACHE_REFRESH", 0) != 0; }
+
+    // Conversation journal: messages loaded per page, and kept in memory per tab
+    inline int getChatHistoryPage() { return getConfigInt("CHAT_HISTORY_PAGE", 50); }
+    inline int getChatMaxResidentMessages() { return getConfigInt("CHAT_MAX_RESIDENT_MESSAGES", 200); }
+
+    // Background tab lifecycle; 0 disables the respective step
+    inline int getTabFreezeAfterSeconds() { return getConfigInt("TAB_FREEZE_AFTER_SECONDS", 120); }
+    inline int getTabDiscardAfterSeconds() { return getConfigInt("TAB_DISCARD_AFTER_SECONDS", 1800); }
+    inline int getTabMemoryBudgetMb() { return getConfigInt("TAB_MEMORY_BUDGET_MB", 2048); }
+    inline int getTabEstimatedMb() { return getConfigInt("TAB_ESTIMATED_MB", 150); }
+
+    // Cited pages of the current answer loaded ahead of a click (0 disables)
+    inline int getPreloadTopK() { return getConfigInt("PRELOAD_TOP_K", 3); }
+    inline int getPreloadMaxConcurrent() { return getConfigInt("PRELOAD_MAX_CONCURRENT", 2); }
+    inline int getPreloadMemoryMb() { return getConfigInt("PRELOAD_MEMORY_MB", 450); }
+
+    // Queued follow-ups answered ahead of time in hidden conversations (0 disables)
+    inline int getFollowupSpeculateCount() { return getConfigInt("FOLLOWUP_SPECULATE_COUNT", 0); }
+
+    // Soft token budgets per session; once exceeded, optional background work stops (0 = none)
+    inline int getUsageSessionTokenBudget() { return getConfigInt("USAGE_SESSION_TOKEN_BUDGET", 0); }
+    inline int getUsageBackgroundTokenBudget() { return getConfigInt("USAGE_BACKGROUND_TOKEN_BUDGET", 0); }
+
+    // Approximate app-side memory (chat history, buffers, caches) before cold data is evicted (0 = never)
+    inline int getMemoryHighWaterMb() { return getConfigInt("MEMORY_HIGH_WATER_MB", 256); }
 }
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -0,0 +1,1249 @@
+#include "conversation.h"
+#include "chatbridge.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QNetworkRequest>
+#include <QStandardPaths>
+#include <QRegularExpression>
+#include <QCryptographicHash>
+#include <QDebug>
+#include "config.h"
+#include "jsonwriter.h"
+#include "citationextractor.h"
+#include "memorystats.h"
+
+namespace {
+// System prompts never change, so they are JSON-encoded once per process
+const QByteArray& initialSystemPromptJson() {
+    static const QByteArray encoded = JsonWriter::encodeString(QString(
+        "You are a research assistant with access to the Statista database integrated into a web browser. "
+        "You help users by providing data-driven, factual answers augmented with statistical evidence.\n\n"
+        "CRITICAL INSTRUCTIONS - Follow this workflow:\n"
+        "1. ANALYZE the user's question to determine what data is needed\n"
+        "2. SEARCH using search-statistics tool for relevant data (this is MANDATORY for any factual question)\n"
+        "3. EVALUATE the search results:\n"
+        "   - If results directly answer the question with sufficient detail → STOP and answer\n"
+        "   - If you need specific numbers/trends from a chart → use get-chart-data-by-id for the TOP 1-2 most relevant results\n"
+        "   - If results are not relevant → try ONE more search with different keywords\n"
+        "4. STOP gathering data once you have enough to answer the question comprehensively\n\n"
+        "IMPORTANT GUIDELINES:\n"
+        "• Do NOT make multiple searches unless the first had no relevant results\n"
+        "• Do NOT fetch chart details for more than 2 charts per query\n"
+        "• Do NOT continue searching if you already have data that answers the question\n"
+        "• The system will automatically display citation buttons for all sources used\n"
+        "• Focus on quality over quantity - better to have 1-2 highly relevant sources than 10 tangential ones\n"
+        "• End your final answer with a line \"**Follow-up questions:**\" and 2-3 short bullet points the user could ask next\n\n"
+        "Remember: You are a ReAct agent - Reason about what's needed, Act to get it, then STOP when you have enough."));
+    return encoded;
+}
+
+const QByteArray& toolResultSystemPromptJson() {
+    static const QByteArray encoded = JsonWriter::encodeString(QString(
+        "You are a research assistant with access to the Statista database integrated into a web browser. "
+        "You help users by providing data-driven, factual answers augmented with statistical evidence.\n\n"
+        "CRITICAL: You just received tool results. Now EVALUATE:\n"
+        "1. Do you have enough data to comprehensively answer the user's question?\n"
+        "   - YES → Provide your answer now using the data you've gathered\n"
+        "   - NO → Use ONE more tool call (either get-chart-data-by-id for details OR search-statistics with better keywords)\n\n"
+        "STOPPING CRITERIA - You have enough data when:\n"
+        "• The search results contain statistics that directly address the user's question\n"
+        "• You have specific numbers, percentages, or trends relevant to the query\n"
+        "• Additional searches would only provide redundant or tangential information\n\n"
+        "IMPORTANT:\n"
+        "• Maximum 2 searches per user query (unless first search completely failed)\n"
+        "• Maximum 2 chart detail fetches per query\n"
+        "• The system displays citations automatically - don't include links\n"
+        "• If you have relevant data, STOP searching and provide the answer\n"
+        "• End your final answer with a line \"**Follow-up questions:**\" and 2-3 short bullet points the user could ask next\n\n"
+        "Present your findings clearly and directly answer the user's question with the concrete data you've gathered."));
+    return encoded;
+}
+
+// Approximate bytes of a tool result, from its content texts
+qint64 resultBytes(const QJsonObject& result) {
+    qint64 bytes = 256;
+    for (const auto& c : result.value("result").toObject().value("content").toArray())
+        bytes += c.toObject().value("text").toString().size() * 2;
+    return bytes;
+}
+
+// Removes the trailing "Follow-up questions:" list the system prompts ask for
+// and returns its items; the chat shows them as follow-up chips instead
+QStringList takeFollowupSection(QString& content) {
+    static const QRegularExpression heading(R"((^|\n)[*_#\s]*Follow-?up questions:?[*_\s]*\n)",
+                                            QRegularExpression::CaseInsensitiveOption);
+    QRegularExpressionMatch match;
+    const int at = content.lastIndexOf(heading, -1, &match);
+    if (at < 0) return {};
+
+    static const QRegularExpression bullet(R"(^\s*(?:[-*•]|\d+[.)])\s+(.+)$)");
+    QStringList queries;
+    const QStringList lines = content.mid(at + match.capturedLength()).split('\n');
+    for (const QString& line : lines) {
+        if (line.trimmed().isEmpty()) continue;
+        const QRegularExpressionMatch item = bullet.match(line);
+        // Anything but a list after the heading: not the section we asked for
+        if (!item.hasMatch()) return {};
+        queries << item.captured(1).remove('*').trimmed();
+    }
+    content.truncate(at);
+    content = content.trimmed();
+    return queries;
+}
+}
+
+Conversation::Conversation(const QString& key, ChatBridge* bridge, QNetworkAccessManager* net, PassageRetriever* passages)
+    : QObject(bridge), m_key(key), m_bridge(bridge), m_net(net), m_passages(passages) {
+    qDebug() << "Conversation: Created for" << m_key;
+
+    // Internal conversations ("__...") are not worth keeping across restarts
+    if (!m_key.startsWith("__")) {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/conversations/";
+        m_journal = std::make_unique<ConversationJournal>(dir + QString::fromLatin1(m_key.toUtf8().toPercentEncoding()));
+        if (m_journal->open()) {
+            // Reopen with just the newest page; older ones load on scroll
+            const int total = m_journal->messageCount();
+            m_firstResident = qMax(0, total - Config::getChatHistoryPage());
+            m_messages = m_journal->readMessages(m_firstResident, total - m_firstResident);
+            // The history sent to Claude has to open with a user turn
+            const int skip = firstUserMessage(0);
+            m_messages.erase(m_messages.begin(), m_messages.begin() + skip);
+            m_firstResident += skip;
+            if (!m_messages.isEmpty()) qDebug() << "Conversation: Restored" << m_messages.size() << "of" << total << "messages for" << m_key;
+        } else {
+            qDebug() << "Conversation: Cannot open journal for" << m_key;
+            m_journal.reset();
+        }
+    }
+}
+
+bool Conversation::isStreaming() const {
+    return (m_reply && m_reply->isRunning()) || !m_pendingToolCalls.isEmpty() || m_followActive;
+}
+
+void Conversation::startTiming() {
+    m_requestTimer.start();
+    m_ttftMs = -1;
+}
+
+void Conversation::abort() {
+    // Stop any in-flight stream; late tool results are dropped by handleToolResult
+    if (m_reply) {
+        QNetworkReply* reply = m_reply;
+        m_reply = nullptr;
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_buffer.clear();
+    clearToolState();
+    stopFollowing();
+}
+
+void Conversation::clearToolState() {
+    // Per-call bookkeeping of a tool loop that will not continue; left behind
+    // it would pile up for the lifetime of the tab
+    m_currentToolName.clear();
+    m_currentToolIdx = -1;
+    m_currentToolId.clear();
+    m_currentToolInput.clear();
+    m_partialInput.reset();
+    m_earlyDispatches.clear();
+    m_deferredToolResults.clear();
+    m_pendingToolCalls.clear();
+    m_toolCallDetails.clear();
+    m_parsedToolText.clear();
+}
+
+void Conversation::reset() {
+    // Don't abort - let pending requests finish naturally
+    // They'll be ignored since we're resetting state
+    m_reply = nullptr;
+    stopFollowing();
+    m_messages.clear();
+    m_followups.clear();
+    m_contextBlock.clear();
+    m_contextMessageIndex = -1;
+    m_historyJson.clear();
+    m_encodedMessages = 0;
+    m_firstResident = 0;
+    if (m_journal) m_journal->clear();
+    emit messagesChanged();
+    emit followupsChanged();
+}
+
+void Conversation::discardJournal() {
+    if (m_journal) m_journal->clear();
+    m_journal.reset();
+}
+
+void Conversation::journalMessage(int index) {
+    if (!m_journal || index < 0 || index >= m_messages.size()) return;
+    auto m = m_messages.at(index).toMap();
+    if (m.value("persisted").toBool()) return;
+    m["persisted"] = true;
+    m_messages[index] = m;
+    // Rendered HTML is derived from content and not worth the disk space
+    m.remove("html");
+    m_journal->appendMessage(m);
+}
+
+int Conversation::loadOlder(int count) {
+    if (!m_journal || m_firstResident == 0 || count <= 0) return 0;
+    const int first = qMax(0, m_firstResident - count);
+    const QVariantList older = m_journal->readMessages(first, m_firstResident - first);
+    if (older.isEmpty()) return 0;
+    m_firstResident = first;
+    m_messages = older + m_messages;
+    if (m_contextMessageIndex >= 0) m_contextMessageIndex += older.size();
+    // Indexes shifted, so the encoded history has to be rebuilt
+    m_historyJson.clear();
+    m_encodedMessages = 0;
+    qDebug() << "Conversation: Loaded" << older.size() << "older messages for" << m_key;
+    emit messagesChanged();
+    return older.size();
+}
+
+void Conversation::trimResident() {
+    // Long sessions keep only the newest messages in memory; the rest stay in
+    // the journal. Without a journal the history is all there is, so keep it.
+    const int limit = Config::getChatMaxResidentMessages();
+    if (!m_journal || limit <= 0 || m_messages.size() <= limit) return;
+    // Cut at a user message so the history sent to Claude still opens with one;
+    // tool rounds and system notes make the count uneven
+    const int drop = firstUserMessage(m_messages.size() - limit);
+    int persisted = 0;
+    for (int i = 0; i < drop; ++i) {
+        if (m_messages.at(i).toMap().value("persisted").toBool()) ++persisted;
+    }
+    m_messages.erase(m_messages.begin(), m_messages.begin() + drop);
+    m_firstResident += persisted;
+    m_contextMessageIndex = -1;
+    m_contextBlock.clear();
+    m_historyJson.clear();
+    m_encodedMessages = 0;
+    qDebug() << "Conversation: Trimmed" << drop << "resident messages for" << m_key;
+}
+
+int Conversation::firstUserMessage(int from) const {
+    int i = qMax(0, from);
+    while (i < m_messages.size() && m_messages.at(i).toMap().value("role").toString() != "user") ++i;
+    return i;
+}
+
+QByteArray Conversation::priorTurnsHash() const {
+    // The turns Claude sees before the question sendMessage just appended
+    const int end = m_messages.size() - 1;
+    const int first = firstUserMessage(0);
+    if (first >= end) return QByteArray();
+    QCryptographicHash h(QCryptographicHash::Sha1);
+    for (int i = first; i < end; ++i) {
+        const auto m = m_messages.at(i).toMap();
+        const QString role = m.value("role").toString();
+        if (role == "system") continue;
+        h.addData(role.toUtf8());
+        h.addData(QByteArrayView("\n"));
+        h.addData(m.value("content").toString().toUtf8());
+        h.addData(QByteArrayView("\n"));
+    }
+    return h.result();
+}
+
+QVariantMap Conversation::memoryUsage() const {
+    qint64 toolState = MemoryStats::approxBytes(m_currentToolInput) + MemoryStats::approxBytes(m_contextBlock);
+    for (const auto& d : m_toolCallDetails) toolState += MemoryStats::approxBytes(d.input) + 64;
+    // Sizes were taken when the results were stored; re-serializing here on every poll would cost more than it measures
+    for (const auto& parsed : m_parsedToolText) toolState += parsed.bytes;
+    for (const auto& r : m_deferredToolResults) toolState += r.bytes;
+    toolState += m_earlyDispatches.size() * 256;
+
+    qint64 citations = 0;
+    for (const auto& c : m_currentCitations) citations += MemoryStats::approxBytes(QVariant(c));
+
+    return {
+        {"messages", MemoryStats::approxBytes(QVariant(m_messages))},
+        {"buffers", MemoryStats::approxBytes(m_buffer) + MemoryStats::approxBytes(m_payload)
+                    + MemoryStats::approxBytes(m_historyJson)},
+        {"toolState", toolState},
+        {"citations", citations}
+    };
+}
+
+qint64 Conversation::evictCold(int keepMessages) {
+    // Leave a turn in progress alone; its buffers and tool state are live
+    if (isStreaming() || !m_pendingToolCalls.isEmpty()) return 0;
+    const qint64 before = MemoryStats::approxBytes(QVariant(m_messages)) + MemoryStats::approxBytes(m_buffer)
+                          + MemoryStats::approxBytes(m_payload) + MemoryStats::approxBytes(m_historyJson);
+
+    // Request buffers are rebuilt for the next turn
+    m_buffer = QByteArray();
+    m_payload = QByteArray();
+    m_historyJson = QByteArray();
+    m_encodedMessages = 0;
+
+    if (keepMessages >= 0) {
+        // Older messages already on disk are paged back in on demand (loadOlder)
+        int drop = 0;
+        if (m_journal) {
+            while (drop < m_messages.size() - keepMessages
+                   && m_messages.at(drop).toMap().value("persisted").toBool()) ++drop;
+        }
+        if (drop > 0) {
+            m_messages.erase(m_messages.begin(), m_messages.begin() + drop);
+            m_firstResident += drop;
+            m_contextMessageIndex = -1;
+            m_contextBlock.clear();
+        }
+        // Rendered HTML of what stays is derived data; the view falls back to Markdown
+        for (int i = 0; i < m_messages.size() - keepMessages; ++i) {
+            auto m = m_messages.at(i).toMap();
+            if (m.remove("html")) m_messages[i] = m;
+        }
+        if (drop > 0) emit messagesChanged();
+    }
+
+    const qint64 after = MemoryStats::approxBytes(QVariant(m_messages));
+    return qMax<qint64>(0, before - after);
+}
+
+void Conversation::append(const QString& role, const QString& text) {
+    QVariantMap m; m["role"] = role; m["content"] = text;
+    m_messages << m;
+    journalMessage(m_messages.size() - 1);
+    emit messagesChanged();
+}
+
+void Conversation::updateLastAssistant(const QString& delta) {
+    if (m_messages.isEmpty()) {
+        qDebug() << "Conversation: updateLastAssistant - no messages!";
+        return;
+    }
+    auto last = m_messages.last().toMap();
+    if (last.value("role").toString() != "assistant") {
+        qDebug() << "Conversation: updateLastAssistant - last message is not assistant, it's" << last.value("role").toString();
+        return;
+    }
+    QString oldContent = last.value("content").toString();
+    QString newContent = oldContent + delta;
+    last["content"] = newContent;
+    m_messages[m_messages.size()-1] = last;
+    qDebug() << "Conversation: Updated assistant message, added:" << delta << "Total length:" << newContent.length();
+    m_streamDoc.append(delta);
+    // Only emit partialUpdated during streaming to avoid full redraws
+    emit partialUpdated();
+}
+
+void Conversation::finalizeLastAssistant() {
+    // Render the finished message once; the chat view shows this instead of
+    // re-parsing the markdown on every layout
+    if (m_messages.isEmpty()) return;
+    auto last = m_messages.last().toMap();
+    if (last.value("role").toString() != "assistant") return;
+    last["html"] = MarkdownRenderer::toHtml(last.value("content").toString());
+    m_messages[m_messages.size()-1] = last;
+    journalMessage(m_messages.size() - 1);
+}
+
+void Conversation::replayCachedAnswer(const AnswerCache::Entry& entry) {
+    qDebug() << "Conversation: Answer cache hit, replaying" << entry.text.size() << "chars";
+    // Same path as a live stream so the view and citations update identically
+    QVariantMap assistantMsg;
+    assistantMsg["role"] = "assistant";
+    assistantMsg["content"] = "";
+    assistantMsg["model"] = entry.model;
+    assistantMsg["cached"] = true;
+    m_messages.append(assistantMsg);
+    m_streamDoc.reset();
+    emit messagesChanged();
+
+    updateLastAssistant(entry.text);
+    QList<QVariantMap> cites;
+    for (const auto& c : entry.citations) cites << c.toMap();
+    if (!cites.isEmpty()) addCitations(cites);
+
+    finalizeLastAssistant();
+    emit streamingFinished();
+    emit messagesChanged();
+    m_turnDone = true;
+    emit turnFinished();
+}
+
+void Conversation::refreshAnswer(const QString& userText, const QVariantMap& context) {
+    m_bypassCache = true;
+    sendMessage(userText, context);
+}
+
+void Conversation::addCitations(const QList<QVariantMap>& cites) {
+    // Each source is listed once per turn, however many tool rounds return it
+    const QList<QVariantMap> fresh = m_citations.filterNew(cites);
+    qDebug() << "Conversation: addCitations called with" << cites.size() << "citations," << fresh.size() << "new";
+    if (fresh.isEmpty() || m_messages.isEmpty()) return;
+    
+    auto last = m_messages.last().toMap();
+    QVariantList list = last.value("citations").toList();
+    for (const auto& c : fresh) list << c;
+    last["citations"] = list;
+    m_messages[m_messages.size()-1] = last;
+    
+    // Store citations for appending to message later
+    m_currentCitations.append(fresh);
+    if (m_journal) m_journal->appendCitations(QVariantList(fresh.begin(), fresh.end()));
+    
+    emit messagesChanged();
+    emit citationsUpdated(fresh);
+}
+
+void Conversation::appendSources() {
+    // Clickable source links under the turn's final message, added once
+    if (m_currentCitations.isEmpty() || m_messages.isEmpty()) return;
+    auto last = m_messages.last().toMap();
+    if (last.value("role").toString() != "assistant" || last.value("hasSources").toBool()) return;
+
+    QString content = last.value("content").toString();
+    content += "\n\n**Sources:**\n";
+    for (const auto& cite : m_currentCitations) {
+        content += QString("- [%1](%2)\n").arg(cite.value("title").toString(), cite.value("url").toString());
+    }
+    last["content"] = content;
+    last["hasSources"] = true;
+    m_messages[m_messages.size()-1] = last;
+    emit messagesChanged();
+}
+
+void Conversation::takeFollowups() {
+    if (m_messages.isEmpty()) return;
+    auto last = m_messages.last().toMap();
+    if (last.value("role").toString() != "assistant") return;
+    QString content = last.value("content").toString();
+    const QStringList queries = takeFollowupSection(content);
+    if (queries.isEmpty()) return;
+    last["content"] = content;
+    m_messages[m_messages.size()-1] = last;
+    // The streamed document still holds the section; the finalized HTML replaces it
+    m_streamDoc.reset();
+    m_streamDoc.append(content);
+
+    QVariantList fups;
+    for (const QString& q : queries) fups << QVariantMap{{"query", q}};
+    m_followups = fups;
+    emit followupsChanged();
+}
+
+QString Conversation::displayText(const QString& userText) {
+    // Make the displayed user message more friendly if it's a follow-up query
+    QString displayText = userText;
+    if (userText.startsWith("Search for statistics about")) {
+        // Convert "Search for statistics about X" to "Ok, searching for statistics on X"
+        QString topic = userText.mid(QString("Search for statistics about").length()).trimmed();
+        if (!topic.isEmpty()) {
+            displayText = QString("Ok, searching for statistics on %1").arg(topic);
+        }
+    } else if (userText.startsWith("Tell me about statistics related to")) {
+        // Convert "Tell me about statistics related to X" to "Ok, searching for statistics on X"  
+        QString topic = userText.mid(QString("Tell me about statistics related to").length()).trimmed();
+        if (!topic.isEmpty()) {
+            displayText = QString("Ok, searching for statistics on %1").arg(topic);
+        }
+    }
+    return displayText;
+}
+
+void Conversation::sendMessage(const QString& userText, const QVariantMap& context) {
+    qDebug() << "Conversation::sendMessage called with:" << userText;
+    qDebug() << "Conversation: Anthropic API key present:" << !m_bridge->anthropicApiKey().isEmpty();
+    
+    // Clear citations from previous messages
+    m_currentCitations.clear();
+    m_citations.reset();
+    emit citationsCleared();
+    
+    if (m_bridge->anthropicApiKey().isEmpty()) { 
+        emit error("Anthropic API key not configured"); 
+        return; 
+    }
+
+    // A new question supersedes whatever this conversation was still streaming
+    if (isStreaming()) {
+        qDebug() << "Conversation: Aborting in-flight turn for new question";
+        abort();
+    }
+    trimResident();
+    
+    m_lastContext = context;
+    append("user", displayText(userText));
+    // Don't create assistant message here - it will be created when streaming starts
+    
+    // Call Claude API for chat response (with original text)
+    sendToClaudeAPI(userText, context);
+}
+
+void Conversation::sendToClaudeAPI(const QString& userText, const QVariantMap& context) {
+    // Clear citations from previous queries
+    m_currentCitations.clear();
+    m_citations.reset();
+    
+    // Pick the model for this turn; tool round-trips reuse it
+    ModelRouter::Route route = m_bridge->router()->route(ModelRouter::featuresFor(userText));
+    m_turnModel = route.model;
+    qDebug() << "Conversation: Routed turn to" << route.model << "-" << route.reason;
+    emit routeSelected(route.model, route.reason);
+    
+    // Repeated question on the same page, after the same earlier turns: replay
+    // the stored answer, no tool loop
+    const QByteArray thread = priorTurnsHash();
+    m_turnCacheKey = AnswerCache::keyFor(userText, context, m_turnModel, thread);
+    AnswerCache::Entry cached;
+    if (!m_bypassCache && m_bridge->lookupAnswer(m_turnCacheKey, &cached)) {
+        m_contextBlock.clear();
+        m_contextMessageIndex = m_messages.size() - 1;
+        replayCachedAnswer(cached);
+        // The refresh runs as a thread's first question, so only those can be refreshed
+        if (Config::getAnswerCacheRefresh() && thread.isEmpty()) m_bridge->refreshAnswer(userText, context);
+        return;
+    }
+    m_bypassCache = false;
+    
+    m_budget.start();
+    m_forceAnswer = false;
+    m_turnDone = false;
+    m_turnUsage = {};
+    m_requestOrigin = m_key.startsWith("__") ? UsageLedger::Origin::Background : UsageLedger::Origin::ChatTurn;
+    
+    // Attach page context to the user message just appended by sendMessage
+    m_contextBlock = buildContextBlock(userText, context);
+    m_contextMessageIndex = m_messages.size() - 1;
+    
+    JsonWriter w = beginPayload(initialSystemPromptJson());
+    endPayload(w);
+    qDebug() << "Conversation: Sending to Claude API," << m_payload.size() << "bytes";
+    qDebug() << "Conversation: Payload:" << m_payload.left(1000);
+    
+    QUrl apiUrl("https://api.anthropic.com/v1/messages");
+    qDebug() << "Conversation: API URL:" << apiUrl.toString();
+    QNetworkRequest req(apiUrl);
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("x-api-key", m_bridge->anthropicApiKey().toUtf8());
+    req.setRawHeader("anthropic-version", "2023-06-01");
+    // Background conversations (answer refreshes, speculative follow-ups) yield to the visible one
+    if (m_key.startsWith("__")) req.setPriority(QNetworkRequest::LowPriority);
+    
+    startTiming();
+    m_reply = m_net->post(req, m_payload);
+    m_buffer.clear();
+
+    qDebug() << "Conversation: Request sent, waiting for response...";
+
+    // Capture reply as QPointer to safely detect deleted objects
+    QPointer<QNetworkReply> reply = m_reply;
+
+    QObject::connect(m_reply.data(), &QNetworkReply::readyRead, this, [this, reply](){
+        if (reply.isNull()) return;
+        auto data = reply->readAll();
+        qDebug() << "Conversation: Received data chunk, size:" << data.size();
+        m_buffer += data;
+        processClaudeStream();
+    });
+
+    QObject::connect(m_reply.data(), &QNetworkReply::finished, this, [this, reply](){
+        if (reply.isNull()) return;
+        qDebug() << "Conversation: Request finished";
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << "Conversation: Claude API error:" << reply->errorString();
+            qDebug() << "Conversation: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+            // Read the error response to see what went wrong
+            auto errorData = reply->readAll();
+            qDebug() << "Conversation: Error response size:" << errorData.size();
+            if (!errorData.isEmpty()) {
+                qDebug() << "Conversation: Error response body:" << errorData;
+                // Try to parse as JSON for better error message
+                auto doc = QJsonDocument::fromJson(errorData);
+                if (doc.isObject()) {
+                    auto error = doc.object()["error"].toObject();
+                    QString errorType = error["type"].toString();
+                    QString errorMsg = error["message"].toString();
+                    qDebug() << "Conversation: API Error Type:" << errorType;
+                    qDebug() << "Conversation: API Error Message:" << errorMsg;
+                    // Show error in chat
+                    updateLastAssistant("Error: " + errorMsg);
+                }
+            }
+            if (reply == m_reply) clearToolState();
+            emit error(QString("API error: %1").arg(reply->errorString()));
+            if (reply == m_reply) {
+                m_turnDone = true;
+                emit turnFinished();
+            }
+        } else {
+            // Process any remaining data on successful completion
+            if (!m_buffer.isEmpty()) {
+                processClaudeStream();
+            }
+        }
+        // Whatever is left is an incomplete line that will never be finished
+        if (reply == m_reply) m_buffer.clear();
+        reply->deleteLater();
+        flushDeferredToolResults();
+    });
+}
+
+QString Conversation::buildContextBlock(const QString& question, const QVariantMap& context) {
+    if (context.isEmpty()) return QString();
+
+    QStringList lines;
+    auto page = context.value("page").toMap();
+    if (!page.value("url").toString().isEmpty()) lines << "URL: " + page.value("url").toString();
+    if (!page.value("title").toString().isEmpty()) lines << "Title: " + page.value("title").toString();
+    QStringList themes = context.value("themes").toStringList();
+    if (!themes.isEmpty()) lines << "Page themes: " + themes.join(", ");
+    QString selection = context.value("selection").toString().trimmed();
+    if (!selection.isEmpty()) lines << "Selected text: " + selection;
+
+    // Only the passages relevant to this question, within the configured budget
+    QStringList passages = m_passages->retrieve(context.value("pageText").toString(), question,
+                                               Config::getPageContextTokenBudget(),
+                                               Config::getPageContextTopK());
+    if (!passages.isEmpty()) {
+        lines << "Relevant page excerpts:";
+        for (int i = 0; i < passages.size(); ++i) lines << QString("[%1] %2").arg(i + 1).arg(passages.at(i));
+    }
+    qDebug() << "Conversation: Page context with" << passages.size() << "passages";
+
+    if (lines.isEmpty()) return QString();
+    return "<page_context>\n" + lines.join('\n') + "\n</page_context>";
+}
+
+JsonWriter Conversation::beginPayload(const QByteArray& systemPromptJson) {
+    // Reuse the buffer; the previous request's bytes have been handed to the network
+    m_payload.truncate(0);
+    JsonWriter w(&m_payload);
+    w.beginObject();
+    w.key("model"); w.value(m_turnModel);
+    w.key("max_tokens"); w.value(1024);
+    w.key("temperature"); w.value(0.7);
+    w.key("stream"); w.value(true);
+    w.key("system"); w.raw(systemPromptJson);
+    // Tool set comes from the registry (tools/list, cached) already serialized
+    w.key("tools"); w.raw(m_bridge->tools()->toolsJson());
+    w.key("messages");
+    w.beginArray();
+    writeHistory(w);
+    return w;
+}
+
+void Conversation::endPayload(JsonWriter& w, bool forceAnswer) {
+    w.endArray();
+    if (forceAnswer) {
+        w.key("tool_choice");
+        w.raw(R"({"type":"none"})");
+    }
+    w.endObject();
+}
+
+void Conversation::writeMessage(JsonWriter& w, int index) const {
+    auto m = m_messages.at(index).toMap();
+    QString role = m.value("role").toString();
+    QString content = m.value("content").toString();
+    // Skip empty assistant placeholders and local-only system notes
+    if (content.isEmpty() || role == "system") return;
+    if (index == m_contextMessageIndex && !m_contextBlock.isEmpty()) {
+        content = m_contextBlock + "\n\n" + content;
+    }
+    w.beginObject();
+    w.key("role"); w.value(role);
+    w.key("content"); w.value(content);
+    w.endObject();
+}
+
+void Conversation::writeHistory(JsonWriter& w) {
+    // Messages before the current turn's user message are final, so they are
+    // encoded once and cached; only the current turn is encoded per request.
+    // Older pages loaded on scroll or evictions can leave assistant messages
+    // first; those are not sent, since the API expects a user turn first.
+    const int first = firstUserMessage(0);
+    const int stableEnd = qBound(0, m_contextMessageIndex, int(m_messages.size()));
+    if (m_encodedMessages > stableEnd) {
+        m_historyJson.clear();
+        m_encodedMessages = 0;
+    }
+    if (m_encodedMessages < stableEnd) {
+        JsonWriter cache(&m_historyJson);
+        for (; m_encodedMessages < stableEnd; ++m_encodedMessages) {
+            if (m_encodedMessages >= first) writeMessage(cache, m_encodedMessages);
+        }
+    }
+    w.raw(m_historyJson);
+    for (int i = qMax(stableEnd, first); i < m_messages.size(); ++i) writeMessage(w, i);
+}
+
+void Conversation::processClaudeStream() {
+    qDebug() << "Conversation: Processing stream, buffer size:" << m_buffer.size();
+    
+    // Process Server-Sent Events from Claude
+    while (m_buffer.contains("\n\n")) {
+        int idx = m_buffer.indexOf("\n\n");
+        QByteArray eventBlock = m_buffer.left(idx);
+        m_buffer.remove(0, idx + 2);
+        
+        qDebug() << "Conversation: Processing event block:" << eventBlock.left(150);
+        
+        // Parse SSE event - may have multiple lines (event: and data:)
+        QByteArray eventType;
+        QByteArray jsonData;
+        
+        auto lines = eventBlock.split('\n');
+        for (const auto& line : lines) {
+            if (line.startsWith("event: ")) {
+                eventType = line.mid(7);
+            } else if (line.startsWith("data: ")) {
+                jsonData = line.mid(6);
+            }
+        }
+        
+        if (!jsonData.isEmpty()) {
+            if (jsonData == "[DONE]") {
+                qDebug() << "Conversation: Stream complete";
+
+                appendSources();
+                finalizeLastAssistant();
+                emit streamingFinished();
+                emit messagesChanged();
+                continue;
+            }
+            
+            QJsonDocument doc = QJsonDocument::fromJson(jsonData);
+            if (doc.isObject()) {
+                auto obj = doc.object();
+                QString type = obj["type"].toString();
+                qDebug() << "Conversation: SSE event type:" << eventType << "JSON type:" << type;
+                
+                // Create assistant message on first content
+                if (type == "message_start") {
+                    // Add empty assistant message to populate
+                    QVariantMap assistantMsg;
+                    assistantMsg["role"] = "assistant";
+                    assistantMsg["content"] = "";
+                    assistantMsg["model"] = m_turnModel;
+                    m_messages.append(assistantMsg);
+                    m_streamDoc.reset();
+                    // Prompt side of the usage; output tokens follow in message_delta
+                    m_streamUsage = UsageLedger::fromJson(obj.value("message").toObject().value("usage").toObject());
+                    emit messagesChanged();
+                    qDebug() << "Conversation: Created assistant message";
+                }
+                
+                if ((type == "content_block_start" || type == "content_block_delta") && m_ttftMs < 0) {
+                    m_ttftMs = m_requestTimer.elapsed();
+                }
+
+                if (type == "content_block_delta") {
+                    auto delta = obj["delta"].toObject();
+                    if (delta["type"].toString() == "text_delta") {
+                        QString text = delta["text"].toString();
+                        updateLastAssistant(text);
+                    } else if (delta["type"].toString() == "input_json_delta") {
+                        // Tool use in progress - accumulate the JSON
+                        QString partial = delta["partial_json"].toString();
+                        m_currentToolInput.append(partial);
+                        qDebug() << "Conversation: Tool input chunk:" << partial;
+                        m_partialInput.feed(partial);
+                        maybeDispatchEarly();
+                    }
+                } else if (type == "content_block_start") {
+                    auto contentBlock = obj["content_block"].toObject();
+                    if (contentBlock["type"].toString() == "tool_use") {
+                        QString toolName = contentBlock["name"].toString();
+                        QString toolId = contentBlock["id"].toString();
+                        qDebug() << "Conversation: Tool use started:" << toolName << "ID:" << toolId;
+                        m_currentToolName = toolName;
+                        m_currentToolId = toolId;
+                        m_currentToolInput.clear();
+                        m_partialInput.reset();
+                        
+                        // Add descriptive message about what tool is being used
+                        m_currentToolIdx = m_bridge->tools()->idOf(toolName);
+                        updateLastAssistant(m_bridge->tools()->progressMessage(m_currentToolIdx, toolName));
+                    }
+                } else if (type == "content_block_stop") {
+                    // Tool use complete, store details and execute it
+                    if (!m_currentToolName.isEmpty()) {
+                        // Store tool details for later use in sendToolResult
+                        ToolCallDetails details;
+                        details.name = m_currentToolName;
+                        details.input = m_currentToolInput;
+                        details.toolIdx = m_currentToolIdx;
+                        m_toolCallDetails[m_currentToolId] = details;
+                        if (m_journal) m_journal->appendToolCall(m_currentToolName, m_currentToolInput);
+                        qDebug() << "Conversation: Stored tool details for ID:" << m_currentToolId << "Name:" << m_currentToolName;
+                        
+                        const QString earlyId = m_currentToolId + ":early";
+                        if (m_earlyDispatches.contains(earlyId)) {
+                            // Budget was checked when the early call went out
+                            m_budget.recordToolCall(m_currentToolName);
+                            verifyEarlyDispatch(m_currentToolId, QJsonDocument::fromJson(m_currentToolInput.toUtf8()).object());
+                        } else if (!m_budget.allowsToolCall(m_currentToolName)) {
+                            answerOverBudget(m_currentToolId, m_budget.exhaustedReason(m_currentToolName));
+                        } else {
+                            m_budget.recordToolCall(m_currentToolName);
+                            executeToolCall(m_currentToolName, m_currentToolId, m_currentToolInput);
+                        }
+                        m_currentToolName.clear();
+                        m_currentToolId.clear();
+                        m_currentToolInput.clear();
+                        m_currentToolIdx = -1;
+                        m_partialInput.reset();
+                    }
+                } else if (type == "message_delta") {
+                    auto delta = obj["delta"].toObject();
+                    // Cumulative for the message; any prompt counts here supersede message_start's
+                    const UsageLedger::Usage latest = UsageLedger::fromJson(obj.value("usage").toObject());
+                    m_streamUsage.output = qMax(m_streamUsage.output, latest.output);
+                    if (latest.input > 0) m_streamUsage.input = latest.input;
+                    if (latest.cacheRead > 0) m_streamUsage.cacheRead = latest.cacheRead;
+                    if (latest.cacheWrite > 0) m_streamUsage.cacheWrite = latest.cacheWrite;
+                    if (delta.contains("stop_reason")) {
+                        QString stopReason = delta["stop_reason"].toString();
+                        qDebug() << "Conversation: Message stopped with reason:" << stopReason;
+                        if (m_requestTimer.isValid() && m_ttftMs >= 0) {
+                            m_bridge->router()->recordTiming(m_turnModel, m_ttftMs, m_requestTimer.elapsed());
+                        }
+                        m_requestTimer.invalidate();
+                        m_turnUsage += m_bridge->usage()->record(m_requestOrigin, m_key, m_turnModel, m_streamUsage);
+                        m_streamUsage = {};
+                        
+                        // A tool_use stop is not the answer yet; follow-ups and sources go with the final message
+                        if (stopReason != "tool_use") {
+                            takeFollowups();
+                            appendSources();
+                        }
+                        
+                        if (stopReason != "tool_use" && !m_messages.isEmpty()) {
+                            // The answer carries what the whole turn cost
+                            auto last = m_messages.last().toMap();
+                            last["usage"] = m_turnUsage.toMap();
+                            m_messages[m_messages.size()-1] = last;
+                        }
+                        finalizeLastAssistant();
+                        if (stopReason == "end_turn" && !m_turnCacheKey.isEmpty()) {
+                            // Final answer of the turn (not a tool_use pause): remember it
+                            AnswerCache::Entry entry;
+                            entry.text = m_messages.last().toMap().value("content").toString();
+                            entry.model = m_turnModel;
+                            for (const auto& c : m_currentCitations) entry.citations << c;
+                            m_bridge->storeAnswer(m_turnCacheKey, entry);
+                            m_turnCacheKey.clear();
+                        }
+                        emit streamingFinished();
+                        emit messagesChanged();
+                        if (stopReason != "tool_use") {
+                            m_turnDone = true;
+                            emit turnFinished();
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Conversation::executeToolCall(const QString& toolName, const QString& toolId, const QString& toolInput) {
+    qDebug() << "Conversation: Executing tool:" << toolName << "with input:" << toolInput;
+    
+    QJsonDocument inputDoc = QJsonDocument::fromJson(toolInput.toUtf8());
+    QJsonObject inputObj = inputDoc.object();
+    
+    // Store the tool ID so we can match the response
+    m_pendingToolCalls[toolId] = true;
+    
+    // ChatBridge routes the call to the analyzer and the result back to us
+    emit toolCallRequested(toolName, inputObj, toolId);
+}
+
+void Conversation::maybeDispatchEarly() {
+    // Only read-only tools: a wrong guess just costs one discarded call
+    if (m_currentToolIdx < 0 || m_currentToolId.isEmpty()) return;
+    const QString earlyId = m_currentToolId + ":early";
+    if (m_earlyDispatches.contains(earlyId) || !m_bridge->tools()->isReadOnly(m_currentToolName)) return;
+    if (!m_budget.allowsToolCall(m_currentToolName)) return;
+    const QStringList required = m_bridge->tools()->requiredArgs(m_currentToolIdx);
+    if (required.isEmpty() || !m_partialInput.hasAll(required)) return;
+
+    EarlyDispatch early;
+    early.toolId = m_currentToolId;
+    early.args = m_partialInput.members();
+    m_earlyDispatches.insert(earlyId, early);
+    m_pendingToolCalls[earlyId] = true;
+    qDebug() << "Conversation: Early dispatch of" << m_currentToolName << "with" << early.args.keys();
+    emit toolCallRequested(m_currentToolName, early.args, earlyId);
+}
+
+void Conversation::verifyEarlyDispatch(const QString& toolId, const QJsonObject& finalInput) {
+    const QString earlyId = toolId + ":early";
+    auto it = m_earlyDispatches.find(earlyId);
+    if (earlyArgsMatch(m_toolCallDetails.value(toolId).toolIdx, it->args, finalInput)) {
+        qDebug() << "Conversation: Early dispatch verified for" << toolId;
+        it->verified = true;
+        if (it->hasResult) adoptEarlyResult(earlyId);
+        return;
+    }
+    // Later arguments changed the call (e.g. an optional limit): redo it with the final input
+    qDebug() << "Conversation: Early dispatch mismatch for" << toolId << "- re-dispatching";
+    m_earlyDispatches.erase(it);
+    m_pendingToolCalls.remove(earlyId);
+    const ToolCallDetails details = m_toolCallDetails.value(toolId);
+    executeToolCall(details.name, toolId, details.input);
+}
+
+bool Conversation::earlyArgsMatch(int toolIdx, const QJsonObject& early, const QJsonObject& finalInput) const {
+    // Required arguments have to agree. Optional ones that streamed in after the
+    // early call (e.g. search-statistics' limit) only matter when the two calls
+    // would end up with different values, a missing one counting as its default
+    const QStringList required = m_bridge->tools()->requiredArgs(toolIdx);
+    for (const QString& key : required) {
+        if (early.value(key) != finalInput.value(key)) return false;
+    }
+    const QJsonObject defaults = m_bridge->tools()->argDefaults(toolIdx);
+    QStringList optional = early.keys() + finalInput.keys();
+    optional.removeDuplicates();
+    for (const QString& key : std::as_const(optional)) {
+        if (required.contains(key)) continue;
+        const QJsonValue a = early.contains(key) ? early.value(key) : defaults.value(key);
+        const QJsonValue b = finalInput.contains(key) ? finalInput.value(key) : defaults.value(key);
+        if (a != b) return false;
+    }
+    return true;
+}
+
+void Conversation::answerOverBudget(const QString& toolId, const QString& reason) {
+    qDebug() << "Conversation: Tool budget exhausted (" << reason << ") - answering" << toolId << "locally";
+    m_forceAnswer = true;
+    const QString text = QString("Tool budget for this question exhausted: %1. No more tools can be used; "
+                                 "answer now from the data already gathered.").arg(reason);
+    const QJsonObject synthetic{
+        {"result", QJsonObject{
+            {"content", QJsonArray{QJsonObject{{"type", "text"}, {"text", text}}}},
+            {"isError", true}
+        }}
+    };
+    sendToolResult(toolId, synthetic);
+}
+
+void Conversation::flushDeferredToolResults() {
+    // One continuation at a time; the rest wait for that stream to end
+    if (m_deferredToolResults.isEmpty()) return;
+    const DeferredResult next = m_deferredToolResults.takeFirst();
+    sendToolResult(next.toolId, next.result);
+}
+
+void Conversation::adoptEarlyResult(const QString& requestId) {
+    const EarlyDispatch early = m_earlyDispatches.take(requestId);
+    m_pendingToolCalls.remove(requestId);
+    m_pendingToolCalls[early.toolId] = true;
+    handleToolResult(early.toolId, early.result);
+}
+
+void Conversation::sendToolResult(const QString& toolId, const QJsonObject& result) {
+    qDebug() << "Conversation: sendToolResult called for toolId:" << toolId;
+    // Never start the continuation while the previous stream still writes into m_buffer
+    if (m_reply && m_reply->isRunning()) {
+        qDebug() << "Conversation: Stream still open, deferring tool result for" << toolId;
+        m_deferredToolResults.append({toolId, result, resultBytes(result)});
+        return;
+    }
+    qDebug() << "Conversation: Tool result keys:" << result.keys();
+    
+    // Get stored tool details
+    if (!m_toolCallDetails.contains(toolId)) {
+        qDebug() << "Conversation: No stored tool details found for toolId:" << toolId;
+        m_parsedToolText.remove(toolId);
+        emit error("Internal error: missing tool details");
+        return;
+    }
+    
+    ToolCallDetails toolDetails = m_toolCallDetails.value(toolId);
+    qDebug() << "Conversation: Retrieved tool details - Name:" << toolDetails.name << "Input length:" << toolDetails.input.length();
+    
+    // Extract actual content from MCP result (result.content[0].text);
+    // citations were already taken from it in handleToolResult
+    QString toolResultText = result.value("result").toObject().value("content").toArray()
+                                 .at(0).toObject().value("text").toString();
+    // Budget refusals and failed MCP calls must not read as successful output
+    const bool isError = result.value("result").toObject().value("isError").toBool();
+    const QJsonDocument parsedText = m_parsedToolText.take(toolId).doc;
+    
+    // Fallback if extraction fails
+    if (toolResultText.isEmpty()) {
+        qDebug() << "Conversation: Could not extract text from MCP result, using full result as fallback";
+        toolResultText = QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact));
+    }
+    
+    // Project, cap and compact the payload per tool before Claude sees it
+    toolResultText = parsedText.isNull()
+        ? m_bridge->resultReducer()->reduce(toolDetails.name, toolResultText).text
+        : m_bridge->resultReducer()->reduce(toolDetails.name, toolResultText, parsedText).text;
+    
+    // Each continuation is a round-trip; the last one allowed must produce the answer
+    m_budget.recordRoundTrip();
+    const bool forceAnswer = m_forceAnswer || m_budget.mustAnswer();
+    if (forceAnswer) {
+        qDebug() << "Conversation: Forcing final answer after" << m_budget.toolCalls() << "tool calls,"
+                 << m_budget.roundTrips() << "round-trips," << m_budget.elapsedMs() << "ms";
+    }
+    
+    // Reconstruct conversation history - include ALL messages to maintain context
+    JsonWriter w = beginPayload(toolResultSystemPromptJson());
+    
+    // Add assistant message with tool_use (following Python pattern lines 168-172)
+    // The streamed input is already JSON; pass it through once it validates
+    QByteArray toolInput = toolDetails.input.toUtf8().trimmed();
+    if (!QJsonDocument::fromJson(toolInput).isObject()) toolInput = "{}";
+    w.beginObject();
+    w.key("role"); w.value("assistant");
+    w.key("content");
+    w.beginArray();
+    w.beginObject();
+    w.key("type"); w.value("tool_use");
+    w.key("id"); w.value(toolId);
+    w.key("name"); w.value(toolDetails.name);
+    w.key("input"); w.raw(toolInput);
+    w.endObject();
+    w.endArray();
+    w.endObject();
+    
+    // Add user message with tool_result (following Python pattern lines 174-180)
+    w.beginObject();
+    w.key("role"); w.value("user");
+    w.key("content");
+    w.beginArray();
+    w.beginObject();
+    w.key("type"); w.value("tool_result");
+    w.key("tool_use_id"); w.value(toolId);
+    w.key("content"); w.value(toolResultText);
+    if (isError) { w.key("is_error"); w.value(true); }
+    w.endObject();
+    w.endArray();
+    w.endObject();
+    endPayload(w, forceAnswer);
+    
+    // Clean up stored tool details
+    m_toolCallDetails.remove(toolId);
+    
+    qDebug() << "Conversation: Continuing with tool result, sending to Claude API";
+    qDebug() << "Conversation: Payload summary -" << m_payload.size() << "bytes, model:" << m_turnModel;
+    qDebug() << "Conversation: Full payload being sent to Claude API:" << m_payload.left(1000) + "...";
+    postToClaudeAPI(m_payload);
+}
+
+void Conversation::runFollowupQueue(const QVariantMap& context) {
+    // Consume m_followups FIFO; for brevity just send the first and pop.
+    if (m_followups.isEmpty()) return;
+    auto f = m_followups.first().toMap();
+    m_followups.removeFirst();
+    emit followupsChanged();
+    sendMessage(f.value("query").toString(), context);
+}
+
+QString Conversation::nextFollowup() const {
+    return m_followups.isEmpty() ? QString() : m_followups.first().toMap().value("query").toString();
+}
+
+void Conversation::runFollowupFrom(Conversation* speculation, const QVariantMap& context) {
+    if (m_followups.isEmpty()) return;
+    const QString query = nextFollowup();
+    m_followups.removeFirst();
+    emit followupsChanged();
+
+    m_currentCitations.clear();
+    m_citations.reset();
+    emit citationsCleared();
+    if (isStreaming()) abort();
+    trimResident();
+
+    m_lastContext = context;
+    append("user", displayText(query));
+    qDebug() << "Conversation: Answering follow-up from speculation" << speculation->key() << (speculation->isTurnDone() ? "(done)" : "(in flight)");
+    m_following = speculation;
+    m_followActive = true;
+    m_followBase = m_messages.size();
+    m_streamDoc.reset();
+    mirrorSpeculation();
+    if (speculation->isTurnDone()) {
+        finishFollowing();
+        return;
+    }
+    connect(speculation, &Conversation::partialUpdated, this, &Conversation::mirrorSpeculation);
+    connect(speculation, &Conversation::messagesChanged, this, &Conversation::mirrorSpeculation);
+    connect(speculation, &Conversation::turnFinished, this, &Conversation::finishFollowing);
+    connect(speculation, &Conversation::error, this, &Conversation::error);
+    connect(speculation, &QObject::destroyed, this, &Conversation::finishFollowing);
+}
+
+void Conversation::mirrorSpeculation() {
+    if (!m_following) return;
+    // The speculative conversation holds [user, assistant...] for this turn;
+    // its assistant messages are copied behind m_followBase as they grow
+    const QVariantList theirs = m_following->messages();
+    for (int i = 1; i < theirs.size(); ++i) {
+        const int mine = m_followBase + i - 1;
+        QVariantMap msg = theirs.at(i).toMap();
+        msg.remove("persisted");
+        if (mine >= m_messages.size()) {
+            QVariantMap assistantMsg;
+            assistantMsg["role"] = "assistant";
+            assistantMsg["content"] = "";
+            assistantMsg["model"] = msg.value("model");
+            m_messages.append(assistantMsg);
+            m_streamDoc.reset();
+            emit messagesChanged();
+        }
+        if (mine < m_messages.size() - 1) {
+            m_messages[mine] = msg;
+            continue;
+        }
+        // The newest message streams through updateLastAssistant like a live one
+        const QString have = m_messages.at(mine).toMap().value("content").toString();
+        const QString want = msg.value("content").toString();
+        msg.remove("html");
+        msg["content"] = have;
+        m_messages[mine] = msg;
+        if (want.startsWith(have)) {
+            if (want.size() > have.size()) updateLastAssistant(want.mid(have.size()));
+        } else {
+            msg["content"] = want;
+            m_messages[mine] = msg;
+            m_streamDoc.reset();
+            m_streamDoc.append(want);
+            emit messagesChanged();
+        }
+    }
+
+    const QList<QVariantMap> fresh = m_citations.filterNew(m_following->m_currentCitations);
+    if (!fresh.isEmpty()) {
+        m_currentCitations.append(fresh);
+        if (m_journal) m_journal->appendCitations(QVariantList(fresh.begin(), fresh.end()));
+        emit citationsUpdated(fresh);
+    }
+}
+
+void Conversation::finishFollowing() {
+    // Also reached from destroyed(), when m_following is already null
+    if (!m_followActive) return;
+    mirrorSpeculation();
+    // The speculative answer's own suggestions replace the rest of the queue, as a live answer's would
+    if (m_following && !m_following->followups().isEmpty()) {
+        m_followups = m_following->followups();
+        emit followupsChanged();
+    }
+    stopFollowing();
+    for (int i = m_followBase; i < m_messages.size() - 1; ++i) journalMessage(i);
+    if (m_messages.size() > m_followBase) {
+        auto last = m_messages.last().toMap();
+        last["speculative"] = true;
+        m_messages[m_messages.size()-1] = last;
+    }
+    finalizeLastAssistant();
+    emit streamingFinished();
+    emit messagesChanged();
+}
+
+void Conversation::stopFollowing() {
+    if (m_following) disconnect(m_following, nullptr, this, nullptr);
+    m_following = nullptr;
+    m_followActive = false;
+}
+
+void Conversation::handleToolResult(const QString& requestId, const QJsonObject& result) {
+    qDebug() << "Conversation: handleToolResult called with requestId:" << requestId;
+    qDebug() << "Conversation: Pending tool calls:" << m_pendingToolCalls.keys();
+    // Results for calls dropped by abort() or reset() must not touch this conversation
+    if (!m_pendingToolCalls.contains(requestId)) {
+        qDebug() << "Conversation: No pending tool call found for requestId:" << requestId;
+        return;
+    }
+    auto early = m_earlyDispatches.find(requestId);
+    if (early != m_earlyDispatches.end()) {
+        // Hold the result until the final input confirms the early call's arguments
+        early->result = result;
+        early->hasResult = true;
+        if (early->verified) adoptEarlyResult(requestId);
+        return;
+    }
+    qDebug() << "Conversation: Tool result keys:" << result.keys();
+    
+    // Parse each content text once: citations come from it here, and the
+    // reducer reuses the first one in sendToolResult
+    // The structure is: result -> content -> [items whose text is a JSON string]
+    const QJsonArray contentArr = result.value("result").toObject().value("content").toArray();
+    QList<QVariantMap> citations;
+    for (int i = 0; i < contentArr.size(); ++i) {
+        const QJsonValue text = contentArr.at(i).toObject().value("text");
+        const QJsonDocument textDoc = text.isObject() ? QJsonDocument(text.toObject())
+                                                      : QJsonDocument::fromJson(text.toString().toUtf8());
+        if (i == 0 && text.isString()) {
+            // Parsed form held roughly twice the UTF-16 text
+            m_parsedToolText.insert(requestId, ParsedToolText{textDoc, text.toString().size() * 4});
+        }
+        citations << CitationExtractor::extract(textDoc.object());
+    }
+    if (!citations.isEmpty()) addCitations(citations);
+    
+    m_pendingToolCalls.remove(requestId);
+    sendToolResult(requestId, result);
+}
+
+void Conversation::postToClaudeAPI(const QByteArray& payload) {
+    // Don't abort old requests - let them finish naturally
+    // Just clear our reference to allow new request
+    m_reply = nullptr;
+    // Continuations after tool results are accounted separately from the opening request
+    m_requestOrigin = m_key.startsWith("__") ? UsageLedger::Origin::Background : UsageLedger::Origin::ToolRoundTrip;
+
+    QString claudeEndpoint = "https://api.anthropic.com/v1/messages";
+    qDebug() << "Conversation: API URL:" << claudeEndpoint;
+    qDebug() << "Conversation: Anthropic API key present:" << !m_bridge->anthropicApiKey().isEmpty();
+    
+    QNetworkRequest req(claudeEndpoint);
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("accept", "text/event-stream");
+    req.setRawHeader("anthropic-version", "2023-06-01");
+    if (!m_bridge->anthropicApiKey().isEmpty()) {
+        req.setRawHeader("x-api-key", m_bridge->anthropicApiKey().toUtf8());
+    }
+    
+    if (m_key.startsWith("__")) req.setPriority(QNetworkRequest::LowPriority);
+
+    qDebug() << "Conversation: Request sent, waiting for response...";
+    startTiming();
+    m_reply = m_net->post(req, payload);
+
+    // Capture reply as QPointer to safely detect deleted objects
+    QPointer<QNetworkReply> reply = m_reply;
+    QObject::connect(m_reply.data(), &QNetworkReply::readyRead, this, [this, reply](){
+        if (reply.isNull()) return;
+        m_buffer += reply->readAll();
+        qDebug() << "Conversation: Received data chunk, size:" << m_buffer.size();
+
+        processClaudeStream();
+    });
+
+    QObject::connect(m_reply.data(), &QNetworkReply::finished, this, [this, reply](){
+        if (reply.isNull()) return;
+        qDebug() << "Conversation: Request finished";
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << "Conversation: Network error:" << reply->error() << reply->errorString();
+            qDebug() << "Conversation: HTTP status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        }
+        processClaudeStream();
+        if (reply == m_reply) {
+            if (reply->error() != QNetworkReply::NoError) {
+                clearToolState();
+                m_turnDone = true;
+                emit turnFinished();
+            }
+            m_buffer.clear();
+        }
+        reply->deleteLater();
+        flushDeferredToolResults();
+    });
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <QObject>
+#include <QVariantList>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include "passageretriever.h"
+#include "modelrouter.h"
+#include "jsonwriter.h"
+#include "partialjson.h"
+#include "markdownrenderer.h"
+#include "turnbudget.h"
+#include "answercache.h"
+#include "conversationjournal.h"
+#include "citationextractor.h"
+#include "usageledger.h"
+#include <memory>
+
+class ChatBridge;
+
+// One research thread: owns its message model, Claude stream parser and tool-use
+// state so several conversations (one per tab) can stream and run tool loops
+// concurrently. ChatBridge owns the conversations and routes MCP calls for them.
+class Conversation : public QObject {
+    Q_OBJECT
+public:
+    Conversation(const QString& key, ChatBridge* bridge, QNetworkAccessManager* net, PassageRetriever* passages);
+
+    QString key() const { return m_key; }
+    QVariantList messages() const { return m_messages; }
+    QVariantList followups() const { return m_followups; }
+    bool isStreaming() const;
+    MarkdownDocument* streamingDocument() { return &m_streamDoc; }
+    // Older messages still on disk but not resident
+    bool hasOlderMessages() const { return m_firstResident > 0; }
+    // Page up to count older messages in from the journal; returns how many
+    int loadOlder(int count);
+    // Drop the on-disk history (tab closed)
+    void discardJournal();
+    // Approximate bytes held per part (messages, buffers, tool state, citations)
+    QVariantMap memoryUsage() const;
+    // Release request buffers and, when keepMessages >= 0, page out journaled
+    // messages beyond the newest keepMessages; returns approximate bytes freed
+    qint64 evictCold(int keepMessages);
+
+    void reset();
+    void abort();
+    void sendMessage(const QString& userText, const QVariantMap& context);
+    // Run the question live, skipping the answer cache, and store the new answer
+    void refreshAnswer(const QString& userText, const QVariantMap& context);
+    void runFollowupQueue(const QVariantMap& context);
+    QString nextFollowup() const;
+    // Pop the next follow-up and show the answer a speculative conversation
+    // produced (or is still producing) for it instead of asking again
+    void runFollowupFrom(Conversation* speculation, const QVariantMap& context);
+    // Context of the last question, for follow-ups asked on its behalf
+    QVariantMap lastContext() const { return m_lastContext; }
+    // The current turn reached its final answer or failed
+    bool isTurnDone() const { return m_turnDone; }
+    void handleToolResult(const QString& requestId, const QJsonObject& result);
+
+signals:
+    void messagesChanged();
+    void followupsChanged();
+    void error(const QString& msg);
+    void partialUpdated();
+    void streamingFinished();
+    void citationsUpdated(const QList<QVariantMap>& cites);
+    void citationsCleared(); // a new turn started; earlier citations no longer apply
+    void turnFinished();
+    void routeSelected(const QString& model, const QString& reason);
+    void toolCallRequested(const QString& toolName, const QJsonObject& input, const QString& toolId);
+
+private:
+    void append(const QString& role, const QString& text);
+    void updateLastAssistant(const QString& delta);
+    void finalizeLastAssistant();
+    void journalMessage(int index);
+    void trimResident();
+    int firstUserMessage(int from) const;
+    QByteArray priorTurnsHash() const;
+    void clearToolState();
+    static QString displayText(const QString& userText);
+    void mirrorSpeculation();
+    void finishFollowing();
+    void stopFollowing();
+    void replayCachedAnswer(const AnswerCache::Entry& entry);
+    void addCitations(const QList<QVariantMap>& cites);
+    void appendSources();
+    // Move the answer's "Follow-up questions" list into m_followups
+    void takeFollowups();
+    void sendToClaudeAPI(const QString& userText, const QVariantMap& context);
+    QString buildContextBlock(const QString& question, const QVariantMap& context);
+    JsonWriter beginPayload(const QByteArray& systemPromptJson);
+    void endPayload(JsonWriter& w, bool forceAnswer = false);
+    void writeHistory(JsonWriter& w);
+    void writeMessage(JsonWriter& w, int index) const;
+    void processClaudeStream();
+    void executeToolCall(const QString& toolName, const QString& toolId, const QString& toolInput);
+    void maybeDispatchEarly();
+    void verifyEarlyDispatch(const QString& toolId, const QJsonObject& finalInput);
+    bool earlyArgsMatch(int toolIdx, const QJsonObject& early, const QJsonObject& finalInput) const;
+    void adoptEarlyResult(const QString& requestId);
+    void answerOverBudget(const QString& toolId, const QString& reason);
+    void flushDeferredToolResults();
+    void sendToolResult(const QString& toolId, const QJsonObject& result);
+    void postToClaudeAPI(const QByteArray& payload);
+    void startTiming();
+
+    QString m_key;
+    ChatBridge* m_bridge;
+    QNetworkAccessManager* m_net;
+    PassageRetriever* m_passages;
+
+    QVariantList m_messages;
+    // On-disk history; m_messages holds journal messages from m_firstResident
+    // on, plus whatever the current turn has not finalized yet
+    std::unique_ptr<ConversationJournal> m_journal;
+    int m_firstResident{0};
+    QVariantList m_followups;
+    // Citations of the current turn, deduplicated across tool rounds
+    QList<QVariantMap> m_currentCitations;
+    CitationExtractor m_citations;
+    QByteArray m_buffer;
+    QPointer<QNetworkReply> m_reply;
+    // Incrementally rendered HTML of the assistant message being streamed
+    MarkdownDocument m_streamDoc;
+
+    // Model routed for the current turn and latency of the in-flight request
+    QString m_turnModel;
+    QByteArray m_turnCacheKey; // answer cache key of the current turn
+    bool m_bypassCache{false};
+    QElapsedTimer m_requestTimer;
+    // Token usage of the response being streamed, what caused it, and the turn so far
+    UsageLedger::Usage m_streamUsage;
+    UsageLedger::Origin m_requestOrigin{UsageLedger::Origin::ChatTurn};
+    UsageLedger::Usage m_turnUsage;
+    qint64 m_ttftMs{-1};
+
+    // Page context for the current turn, prepended to that turn's user message
+    // when the history is sent to Claude (never shown in the chat UI)
+    QString m_contextBlock;
+    int m_contextMessageIndex{-1};
+
+    // Request body buffer, and the encoded history before the current turn
+    // (comma-joined message objects covering m_messages[0, m_encodedMessages))
+    QByteArray m_payload;
+    QByteArray m_historyJson;
+    int m_encodedMessages{0};
+
+    // Tool use tracking
+    QString m_currentToolName;
+    QString m_currentToolId;
+    QString m_currentToolInput;
+    int m_currentToolIdx{-1}; // interned ToolRegistry id, -1 if unknown
+    PartialJsonObject m_partialInput;
+
+    // Read-only tool calls started before content_block_stop, once the
+    // streamed input already held every required argument. Keyed by the
+    // request id used for the early call ("<toolId>:early").
+    struct EarlyDispatch {
+        QString toolId;
+        QJsonObject args;
+        bool verified{false};  // final input matched args
+        bool hasResult{false};
+        QJsonObject result;
+    };
+    QHash<QString, EarlyDispatch> m_earlyDispatches;
+
+    // Store tool call details by tool ID for later use in sendToolResult
+    struct ToolCallDetails {
+        QString name;
+        QString input;
+        int toolIdx{-1};
+    };
+    QHash<QString, ToolCallDetails> m_toolCallDetails;
+    // Result text parsed in handleToolResult, reused by the reducer in sendToolResult
+    // (with its approximate size, for memoryUsage)
+    struct ParsedToolText {
+        QJsonDocument doc;
+        qint64 bytes{0};
+    };
+    QHash<QString, ParsedToolText> m_parsedToolText;
+    QHash<QString, bool> m_pendingToolCalls;
+
+    QVariantMap m_lastContext;
+    bool m_turnDone{true};
+    // Speculative conversation whose answer this one is showing, and where
+    // its assistant messages start in m_messages
+    QPointer<Conversation> m_following;
+    bool m_followActive{false};
+    int m_followBase{0};
+
+    // Tool loop limits for the current turn; once exhausted the next request
+    // carries tool_choice "none" so Claude has to answer
+    TurnBudget m_budget;
+    bool m_forceAnswer{false};
+    // Tool results that arrived while the previous stream was still open
+    struct DeferredResult {
+        QString toolId;
+        QJsonObject result;
+        qint64 bytes{0};
+    };
+    QList<DeferredResult> m_deferredToolResults;
+};
@@ -0,0 +1,164 @@
+#include "conversationjournal.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+
+namespace {
+constexpr quint32 kMagic = 0x434A4E4C; // "CJNL"
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 8;
+constexpr qint64 kRecordHeaderSize = 5; // type + length
+}
+
+ConversationJournal::ConversationJournal(const QString& basePath)
+    : m_logPath(basePath + ".log"), m_idxPath(basePath + ".idx") {}
+
+bool ConversationJournal::writeHeader() {
+    QDir().mkpath(QFileInfo(m_logPath).absolutePath());
+    QFile f(m_logPath);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    QDataStream out(&f);
+    out << kMagic << kVersion;
+    QFile::remove(m_idxPath);
+    m_messageOffsets.clear();
+    return out.status() == QDataStream::Ok;
+}
+
+bool ConversationJournal::open() {
+    m_messageOffsets.clear();
+    QFile log(m_logPath);
+    if (!log.exists()) return writeHeader();
+    if (!log.open(QIODevice::ReadWrite)) return false;
+
+    QDataStream in(&log);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        qDebug() << "ConversationJournal: Ignoring incompatible journal" << m_logPath;
+        log.close();
+        return writeHeader();
+    }
+
+    QFile idx(m_idxPath);
+    if (idx.open(QIODevice::ReadOnly)) {
+        QDataStream idxIn(&idx);
+        while (!idxIn.atEnd()) {
+            qint64 offset = 0;
+            idxIn >> offset;
+            if (idxIn.status() != QDataStream::Ok || offset >= log.size()) break;
+            m_messageOffsets.append(offset);
+        }
+        idx.close();
+    }
+
+    // Scan whatever follows the last indexed record; the index may lag the log
+    qint64 pos = kHeaderSize;
+    while (!m_messageOffsets.isEmpty()) {
+        const qint64 last = m_messageOffsets.last();
+        log.seek(last + 1);
+        quint32 length = 0;
+        in >> length;
+        if (in.status() == QDataStream::Ok && last + kRecordHeaderSize + length <= log.size()) {
+            pos = last + kRecordHeaderSize + length;
+            break;
+        }
+        // The indexed record itself was torn; it is cut off with the tail below
+        in.resetStatus();
+        m_messageOffsets.removeLast();
+        pos = last;
+    }
+    // Drop index entries past the kept records so re-indexed ones line up
+    const qint64 idxSize = m_messageOffsets.size() * qint64(sizeof(qint64));
+    if (QFileInfo(m_idxPath).size() > idxSize) QFile::resize(m_idxPath, idxSize);
+
+    int recovered = 0;
+    while (pos + kRecordHeaderSize <= log.size()) {
+        log.seek(pos);
+        quint8 type = 0;
+        quint32 length = 0;
+        in >> type >> length;
+        if (pos + kRecordHeaderSize + length > log.size()) break; // torn write
+        if (Event(type) == Event::Message) {
+            m_messageOffsets.append(pos);
+            appendIndex(pos);
+            ++recovered;
+        }
+        pos += kRecordHeaderSize + length;
+    }
+    if (pos < log.size()) {
+        qDebug() << "ConversationJournal: Dropping truncated tail of" << m_logPath;
+        log.resize(pos);
+    }
+    if (recovered > 0) qDebug() << "ConversationJournal: Re-indexed" << recovered << "messages in" << m_logPath;
+    return true;
+}
+
+bool ConversationJournal::appendRecord(Event type, const QVariantMap& payload, qint64* offset) {
+    QByteArray body;
+    {
+        QDataStream out(&body, QIODevice::WriteOnly);
+        out << payload;
+    }
+    QFile f(m_logPath);
+    if (!f.open(QIODevice::Append)) {
+        qDebug() << "ConversationJournal: Cannot append to" << m_logPath;
+        return false;
+    }
+    if (offset) *offset = f.size();
+    QDataStream out(&f);
+    out << quint8(type) << quint32(body.size());
+    out.writeRawData(body.constData(), body.size());
+    return out.status() == QDataStream::Ok;
+}
+
+bool ConversationJournal::appendIndex(qint64 offset) {
+    QFile f(m_idxPath);
+    if (!f.open(QIODevice::Append)) return false;
+    QDataStream out(&f);
+    out << offset;
+    return out.status() == QDataStream::Ok;
+}
+
+bool ConversationJournal::appendMessage(const QVariantMap& message) {
+    qint64 offset = 0;
+    if (!appendRecord(Event::Message, message, &offset)) return false;
+    m_messageOffsets.append(offset);
+    return appendIndex(offset);
+}
+
+bool ConversationJournal::appendToolCall(const QString& name, const QString& input) {
+    return appendRecord(Event::ToolCall, {{"name", name}, {"input", input},
+                                          {"at", QDateTime::currentMSecsSinceEpoch()}});
+}
+
+bool ConversationJournal::appendCitations(const QVariantList& citations) {
+    return appendRecord(Event::Citations, {{"citations", citations}});
+}
+
+QVariantList ConversationJournal::readMessages(int first, int count) const {
+    QVariantList out;
+    first = qMax(0, first);
+    const int last = qMin(int(m_messageOffsets.size()), first + count);
+    if (first >= last) return out;
+
+    QFile f(m_logPath);
+    if (!f.open(QIODevice::ReadOnly)) return out;
+    QDataStream in(&f);
+    for (int i = first; i < last; ++i) {
+        f.seek(m_messageOffsets.at(i) + kRecordHeaderSize);
+        QVariantMap message;
+        in >> message;
+        if (in.status() != QDataStream::Ok) break;
+        out << message;
+    }
+    return out;
+}
+
+void ConversationJournal::clear() {
+    QFile::remove(m_logPath);
+    QFile::remove(m_idxPath);
+    m_messageOffsets.clear();
+}
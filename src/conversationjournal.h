@@ -0,0 +1,42 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QVariantList>
+#include <QVariantMap>
+
+// Append-only on-disk log of one conversation's events: finalized messages,
+// tool calls and citations. A side index of message record offsets lets a
+// conversation reopen by reading only its newest page and page older messages
+// in on demand, so history never has to be fully resident.
+//
+// <base>.log: header, then records of [type:quint8][length:quint32][payload]
+// <base>.idx: one qint64 offset per message record, appended alongside
+class ConversationJournal {
+public:
+    enum class Event : quint8 { Message = 1, ToolCall = 2, Citations = 3 };
+
+    explicit ConversationJournal(const QString& basePath);
+
+    // Load the index, recovering records the index missed (e.g. after a crash)
+    bool open();
+    int messageCount() const { return m_messageOffsets.size(); }
+
+    bool appendMessage(const QVariantMap& message);
+    bool appendToolCall(const QString& name, const QString& input);
+    bool appendCitations(const QVariantList& citations);
+
+    // Messages [first, first + count) in journal order
+    QVariantList readMessages(int first, int count) const;
+
+    // Delete the files and start empty
+    void clear();
+
+private:
+    bool appendRecord(Event type, const QVariantMap& payload, qint64* offset = nullptr);
+    bool appendIndex(qint64 offset);
+    bool writeHeader();
+
+    QString m_logPath;
+    QString m_idxPath;
+    QVector<qint64> m_messageOffsets;
+};
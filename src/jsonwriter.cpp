@@ -0,0 +1,105 @@
+#include "jsonwriter.h"
+#include <QLocale>
+
+JsonWriter::JsonWriter(QByteArray* out) : m_out(out) {
+    m_needComma.append(!out->isEmpty());
+}
+
+void JsonWriter::separate() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_needComma.last()) m_out->append(',');
+    m_needComma.last() = true;
+}
+
+void JsonWriter::beginObject() {
+    separate();
+    m_out->append('{');
+    m_needComma.append(false);
+}
+
+void JsonWriter::endObject() {
+    m_needComma.removeLast();
+    m_out->append('}');
+}
+
+void JsonWriter::beginArray() {
+    separate();
+    m_out->append('[');
+    m_needComma.append(false);
+}
+
+void JsonWriter::endArray() {
+    m_needComma.removeLast();
+    m_out->append(']');
+}
+
+void JsonWriter::key(const char* name) {
+    if (m_needComma.last()) m_out->append(',');
+    m_needComma.last() = true;
+    m_out->append('"').append(name).append("\":");
+    m_afterKey = true;
+}
+
+void JsonWriter::value(const QString& s) {
+    separate();
+    appendString(*m_out, s);
+}
+
+void JsonWriter::value(const char* s) {
+    value(QString::fromUtf8(s));
+}
+
+void JsonWriter::value(int n) {
+    separate();
+    m_out->append(QByteArray::number(n));
+}
+
+void JsonWriter::value(double d) {
+    separate();
+    m_out->append(QByteArray::number(d, 'g', QLocale::FloatingPointShortest));
+}
+
+void JsonWriter::value(bool b) {
+    separate();
+    m_out->append(b ? "true" : "false");
+}
+
+void JsonWriter::raw(const QByteArray& json) {
+    if (json.isEmpty()) return;
+    separate();
+    m_out->append(json);
+}
+
+void JsonWriter::appendString(QByteArray& out, const QString& s) {
+    static const char hex[] = "0123456789abcdef";
+    const QByteArray utf8 = s.toUtf8();
+    out.reserve(out.size() + utf8.size() + 2);
+    out.append('"');
+    for (char c : utf8) {
+        switch (c) {
+        case '"':  out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        case '\b': out.append("\\b"); break;
+        case '\f': out.append("\\f"); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                out.append("\\u00").append(hex[(c >> 4) & 0xf]).append(hex[c & 0xf]);
+            } else {
+                out.append(c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+QByteArray JsonWriter::encodeString(const QString& s) {
+    QByteArray out;
+    appendString(out, s);
+    return out;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVarLengthArray>
+
+// Minimal streaming JSON writer that appends compact JSON straight into a
+// QByteArray, so request payloads need no QJsonObject tree. Pre-encoded
+// fragments (system prompt, tools, cached history) are spliced in with raw().
+// Top-level values are comma-separated, which lets a writer extend a
+// previously encoded list of array elements.
+class JsonWriter {
+public:
+    explicit JsonWriter(QByteArray* out);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const char* name);
+
+    void value(const QString& s);
+    void value(const char* s);
+    void value(int n);
+    void value(double d);
+    void value(bool b);
+    // Insert an already encoded JSON value (or comma-joined array elements)
+    void raw(const QByteArray& json);
+
+    static void appendString(QByteArray& out, const QString& s);
+    static QByteArray encodeString(const QString& s);
+
+private:
+    void separate();
+
+    QByteArray* m_out;
+    QVarLengthArray<bool, 8> m_needComma; // one entry per open container
+    bool m_afterKey{false};
+};
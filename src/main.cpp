@@ -2,9 +2,17 @@
 #include <QQmlApplicationEngine>
 #include <QtWebEngineQuick/QtWebEngineQuick>
 #include <QQmlContext>
+#include <QQuickWindow>
+#include <QStandardPaths>
 #include "session.h"
 #include "analyzer.h"
 #include "chatbridge.h"
+#include "toolregistry.h"
+#include "tablifecycle.h"
+#include "usageledger.h"
+#include "memorystats.h"
+#include "citationpreloader.h"
+#include "startuptrace.h"
 #include "config.h"
 
 using namespace Qt::StringLiterals;
@@ -12,16 +20,38 @@ using namespace Qt::StringLiterals;
 int main(int argc, char *argv[]) {
     // High-DPI scaling is enabled by default in Qt6
 
+    // Started first so every phase below is measured
+    StartupTrace trace;
+    trace.begin("startup");
+
+    trace.begin("QGuiApplication");
     QGuiApplication app(argc, argv);
     QCoreApplication::setOrganizationName("MicroCo");
     QCoreApplication::setOrganizationDomain("micro.example");
     QCoreApplication::setApplicationName("MicroBrowser");
+    trace.end("QGuiApplication");
 
-    QtWebEngineQuick::initialize();
+    {
+        StartupTrace::Span span(trace, "QtWebEngine initialize");
+        QtWebEngineQuick::initialize();
+    }
 
+    trace.begin("services");
     Session session;
+    TabLifecycle tabLifecycle;
+    // Cached tools/list result; refreshed once the MCP session is ready
+    ToolRegistry toolRegistry;
+    toolRegistry.loadCache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/tools.json");
+    // Token usage of every Claude call, shared so budgets cover the whole session
+    UsageLedger usage;
     Analyzer analyzer;
+    // The MCP handshake is not needed for the first frame
+    analyzer.setDeferSessionInit(true);
     ChatBridge chat;
+    analyzer.setToolRegistry(&toolRegistry);
+    chat.setToolRegistry(&toolRegistry);
+    analyzer.setUsageLedger(&usage);
+    chat.setUsageLedger(&usage);
 
     // Use configuration with embedded defaults (falls back to env vars if set)
     analyzer.setEndpoint(Config::getStatistaMcpEndpoint());
@@ -34,10 +64,30 @@ int main(int argc, char *argv[]) {
     // Connect ChatBridge to Analyzer for MCP calls
     chat.setAnalyzer(&analyzer);
 
+    // App-side memory (web views are budgeted by TabLifecycle); past the
+    // high-water mark cold chat history and rebuildable caches are dropped
+    MemoryStats memoryStats;
+    memoryStats.addProbe("chat", [&chat]() { return chat.memoryStats(); });
+    memoryStats.setEvictor([&chat]() { return chat.evictColdData(); });
+
+    // Cited pages of the active answer are loaded in hidden views ahead of a click
+    CitationPreloader preloader;
+    preloader.setTabLifecycle(&tabLifecycle);
+    QObject::connect(&chat, &ChatBridge::citationsUpdated, &preloader, &CitationPreloader::addCitations);
+    QObject::connect(&chat, &ChatBridge::citationsCleared, &preloader, &CitationPreloader::clear);
+    QObject::connect(&chat, &ChatBridge::activeConversationChanged, &preloader, &CitationPreloader::clear);
+
+    trace.end("services");
+
     QQmlApplicationEngine engine;
     engine.rootContext()->setContextProperty("session", &session);
+    engine.rootContext()->setContextProperty("tabLifecycle", &tabLifecycle);
+    engine.rootContext()->setContextProperty("usage", &usage);
+    engine.rootContext()->setContextProperty("memoryStats", &memoryStats);
+    engine.rootContext()->setContextProperty("citationPreloader", &preloader);
     engine.rootContext()->setContextProperty("analyzer", &analyzer);
     engine.rootContext()->setContextProperty("chat", &chat);
+    engine.rootContext()->setContextProperty("startup", &trace);
 
     const QUrl url(u"qrc:/MicroBrowser/qml/Main.qml"_s);
     QObject::connect(&engine, &QQmlApplicationEngine::objectCreated, &app,
@@ -45,7 +95,23 @@ int main(int argc, char *argv[]) {
                          if (!obj && url == objUrl)
                              QCoreApplication::exit(-1);
                      }, Qt::QueuedConnection);
-    engine.load(url);
+    {
+        // Compiles and creates Main.qml, which restores the tabs up to the active one
+        StartupTrace::Span span(trace, "load Main.qml");
+        engine.load(url);
+    }
+
+    // Deferred until something is on screen: QML restores the remaining
+    // background tabs on firstFrame, then the MCP session is set up
+    QObject::connect(&trace, &StartupTrace::firstFrame, &analyzer, [&trace, &analyzer]() {
+        trace.end("startup");
+        {
+            StartupTrace::Span span(trace, "MCP session start");
+            if (!analyzer.endpoint().isEmpty() && !analyzer.apiKey().isEmpty()) analyzer.initializeSession();
+        }
+        trace.write();
+    }, Qt::QueuedConnection);
+    if (!engine.rootObjects().isEmpty()) trace.watchFirstFrame(qobject_cast<QQuickWindow*>(engine.rootObjects().first()));
 
     return app.exec();
 }
\ No newline at end of file
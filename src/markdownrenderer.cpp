@@ -0,0 +1,192 @@
+#include "markdownrenderer.h"
+#include <QRegularExpression>
+
+namespace {
+const QRegularExpression& headingRe() {
+    static const QRegularExpression re("^(#{1,6})\\s+(.*)$");
+    return re;
+}
+const QRegularExpression& bulletRe() {
+    static const QRegularExpression re("^\\s*[-*+]\\s+(.*)$");
+    return re;
+}
+const QRegularExpression& orderedRe() {
+    static const QRegularExpression re("^\\s*\\d+[.)]\\s+(.*)$");
+    return re;
+}
+const QRegularExpression& ruleRe() {
+    static const QRegularExpression re("^\\s*(-{3,}|\\*{3,}|_{3,})\\s*$");
+    return re;
+}
+}
+
+void MarkdownRenderer::reset() {
+    *this = MarkdownRenderer();
+}
+
+void MarkdownRenderer::append(const QString& delta) {
+    m_carry.append(delta);
+    qsizetype nl;
+    while ((nl = m_carry.indexOf('\n')) != -1) {
+        processLine(m_carry.left(nl));
+        m_carry.remove(0, nl + 1);
+    }
+}
+
+QString MarkdownRenderer::tailHtml() const {
+    // Render a throwaway copy of just the open block, as if the stream ended here
+    MarkdownRenderer tail;
+    tail.m_block = m_block;
+    tail.m_blockLines = m_blockLines;
+    if (!m_carry.isEmpty()) tail.processLine(m_carry);
+    tail.closeBlock();
+    return tail.m_segments.join(QString());
+}
+
+QString MarkdownRenderer::toHtml(const QString& markdown) {
+    MarkdownRenderer r;
+    r.append(markdown);
+    return r.m_segments.join(QString()) + r.tailHtml();
+}
+
+void MarkdownRenderer::processLine(const QString& line) {
+    if (m_block == Block::Code) {
+        if (line.trimmed().startsWith("```")) closeBlock();
+        else m_blockLines << line;
+        return;
+    }
+    const QString trimmed = line.trimmed();
+    if (trimmed.isEmpty()) {
+        closeBlock();
+        return;
+    }
+    if (trimmed.startsWith("```")) {
+        closeBlock();
+        m_block = Block::Code;
+        return;
+    }
+    auto heading = headingRe().match(trimmed);
+    if (heading.hasMatch()) {
+        closeBlock();
+        const int level = heading.capturedLength(1);
+        m_segments << QString("<h%1>%2</h%1>").arg(level).arg(renderInline(heading.captured(2)));
+        return;
+    }
+    if (ruleRe().match(line).hasMatch()) {
+        closeBlock();
+        m_segments << "<hr/>";
+        return;
+    }
+
+    Block kind = Block::Paragraph;
+    if (bulletRe().match(line).hasMatch()) kind = Block::List;
+    else if (orderedRe().match(line).hasMatch()) kind = Block::OrderedList;
+    else if (trimmed.startsWith('>')) kind = Block::Quote;
+
+    // Indented text under a list item continues that item
+    const bool continuation = (m_block == Block::List || m_block == Block::OrderedList) &&
+                              kind == Block::Paragraph && line.at(0).isSpace();
+    if (continuation) {
+        m_blockLines.last() += ' ' + trimmed;
+        return;
+    }
+    if (m_block != Block::None && kind != m_block) closeBlock();
+    m_block = kind;
+    m_blockLines << line;
+}
+
+void MarkdownRenderer::closeBlock() {
+    if (m_blockLines.isEmpty() && m_block != Block::Code) {
+        m_block = Block::None;
+        return;
+    }
+    QString html;
+    switch (m_block) {
+    case Block::Code:
+        html = "<pre>" + m_blockLines.join('\n').toHtmlEscaped() + "</pre>";
+        break;
+    case Block::List:
+    case Block::OrderedList: {
+        const bool ordered = m_block == Block::OrderedList;
+        const QRegularExpression& marker = ordered ? orderedRe() : bulletRe();
+        html = ordered ? "<ol>" : "<ul>";
+        for (const auto& item : m_blockLines) {
+            html += "<li>" + renderInline(marker.match(item).captured(1)) + "</li>";
+        }
+        html += ordered ? "</ol>" : "</ul>";
+        break;
+    }
+    case Block::Quote: {
+        QStringList text;
+        for (const auto& l : m_blockLines) text << l.trimmed().mid(1).trimmed();
+        html = "<blockquote>" + renderInline(text.join(' ')) + "</blockquote>";
+        break;
+    }
+    case Block::Paragraph:
+        html = "<p>" + renderInline(m_blockLines.join(' ')) + "</p>";
+        break;
+    case Block::None:
+        break;
+    }
+    if (!html.isEmpty()) m_segments << html;
+    m_blockLines.clear();
+    m_block = Block::None;
+}
+
+QString MarkdownRenderer::renderInline(const QString& text) {
+    static const QRegularExpression code("`([^`]+)`");
+    static const QRegularExpression bold("\\*\\*(.+?)\\*\\*|__(.+?)__");
+    static const QRegularExpression italic("(?<![*\\w])\\*(?!\\s)(.+?)\\*(?!\\*)|(?<!\\w)_(?!\\s)(.+?)_(?!\\w)");
+    static const QRegularExpression link("\\[([^\\]]+)\\]\\(([^)\\s]+)\\)");
+
+    QString html = text.toHtmlEscaped();
+    html.replace(code, "<code>\\1</code>");
+    html.replace(link, "<a href=\"\\2\">\\1</a>");
+    html.replace(bold, "<b>\\1\\2</b>");
+    html.replace(italic, "<i>\\1\\2</i>");
+    return html;
+}
+
+MarkdownDocument::MarkdownDocument(QObject* parent) : QAbstractListModel(parent) {}
+
+int MarkdownDocument::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return m_finalized + 1;
+}
+
+QVariant MarkdownDocument::data(const QModelIndex& index, int role) const {
+    if (role != HtmlRole || !index.isValid()) return QVariant();
+    if (index.row() < m_finalized) return m_renderer.segments().at(index.row());
+    if (index.row() == m_finalized) return m_tail;
+    return QVariant();
+}
+
+QHash<int, QByteArray> MarkdownDocument::roleNames() const {
+    return {{HtmlRole, "html"}};
+}
+
+void MarkdownDocument::reset() {
+    beginResetModel();
+    m_renderer.reset();
+    m_finalized = 0;
+    m_tail.clear();
+    endResetModel();
+}
+
+void MarkdownDocument::append(const QString& delta) {
+    const int before = m_finalized;
+    m_renderer.append(delta);
+    const int after = m_renderer.segments().size();
+    if (after > before) {
+        // Newly closed blocks go in front of the trailing row
+        beginInsertRows(QModelIndex(), before, after - 1);
+        m_finalized = after;
+        endInsertRows();
+    }
+    const QString tail = m_renderer.tailHtml();
+    if (tail != m_tail || after > before) {
+        m_tail = tail;
+        const QModelIndex last = index(after);
+        emit dataChanged(last, last, {HtmlRole});
+    }
+}
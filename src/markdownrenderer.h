@@ -0,0 +1,53 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QStringList>
+
+// Incremental Markdown → HTML renderer for streamed assistant text. Complete
+// lines are folded into the current block; once a block is closed (blank line,
+// heading, rule, closing code fence) its HTML is finalized and never touched
+// again, so each update only re-renders the trailing open block.
+class MarkdownRenderer {
+public:
+    void reset();
+    void append(const QString& delta);
+
+    const QStringList& segments() const { return m_segments; } // finalized blocks
+    QString tailHtml() const;                                  // open block + partial line
+
+    // One-shot render of a whole message
+    static QString toHtml(const QString& markdown);
+
+private:
+    enum class Block { None, Paragraph, List, OrderedList, Quote, Code };
+    void processLine(const QString& line);
+    void closeBlock();
+    static QString renderInline(const QString& text);
+
+    QString m_carry;          // text after the last newline
+    Block m_block{Block::None};
+    QStringList m_blockLines;
+    QStringList m_segments;
+};
+
+// List model over a MarkdownRenderer for QML: one row per finalized block plus
+// a trailing row for the open block. Finalized rows are inserted once; only the
+// last row changes while a message streams.
+class MarkdownDocument : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Roles { HtmlRole = Qt::UserRole + 1 };
+
+    explicit MarkdownDocument(QObject* parent=nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void reset();
+    void append(const QString& delta);
+
+private:
+    MarkdownRenderer m_renderer;
+    int m_finalized{0}; // rows published for finalized blocks
+    QString m_tail;
+};
@@ -0,0 +1,67 @@
+#include "mcpresilience.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+void LatencyTracker::record(const QString& key, qint64 ms) {
+    Window& w = m_windows[key];
+    if (w.samples.size() < m_windowSize) {
+        w.samples.append(ms);
+    } else {
+        w.samples[w.next] = ms;
+        w.next = (w.next + 1) % m_windowSize;
+    }
+}
+
+int LatencyTracker::sampleCount(const QString& key) const {
+    auto it = m_windows.constFind(key);
+    return it == m_windows.constEnd() ? 0 : int(it->samples.size());
+}
+
+qint64 LatencyTracker::percentile(const QString& key, double p) const {
+    auto it = m_windows.constFind(key);
+    if (it == m_windows.constEnd() || it->samples.isEmpty()) return -1;
+    QVector<qint64> sorted = it->samples;
+    std::sort(sorted.begin(), sorted.end());
+    int idx = int(std::ceil(p * sorted.size())) - 1;
+    idx = std::clamp(idx, 0, int(sorted.size()) - 1);
+    return sorted.at(idx);
+}
+
+bool CircuitBreaker::allowRequest() {
+    if (m_state == State::Closed) return true;
+    if (m_state == State::Open) {
+        if (m_openedAt.isValid() && m_openedAt.elapsed() >= m_cooldownMs) {
+            m_state = State::HalfOpen;
+            m_probeInFlight = false;
+            qDebug() << "CircuitBreaker: Cooldown elapsed, half-open";
+        } else {
+            return false;
+        }
+    }
+    // Half-open: allow exactly one probe at a time
+    if (m_probeInFlight) return false;
+    m_probeInFlight = true;
+    return true;
+}
+
+void CircuitBreaker::recordSuccess() {
+    if (m_state != State::Closed) {
+        qDebug() << "CircuitBreaker: Probe succeeded, closing";
+    }
+    m_state = State::Closed;
+    m_consecutiveFailures = 0;
+    m_probeInFlight = false;
+}
+
+void CircuitBreaker::recordFailure() {
+    m_probeInFlight = false;
+    ++m_consecutiveFailures;
+    if (m_state == State::HalfOpen || m_consecutiveFailures >= m_failureThreshold) {
+        if (m_state != State::Open) {
+            qDebug() << "CircuitBreaker: Opening after" << m_consecutiveFailures << "consecutive failures";
+        }
+        m_state = State::Open;
+        m_openedAt.restart();
+    }
+}
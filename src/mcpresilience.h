@@ -0,0 +1,49 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+
+// Rolling per-tool latency samples used to derive adaptive timeouts and
+// hedging delays for MCP tool calls.
+class LatencyTracker {
+public:
+    explicit LatencyTracker(int windowSize = 64) : m_windowSize(windowSize) {}
+
+    void record(const QString& key, qint64 ms);
+    int sampleCount(const QString& key) const;
+    // Returns -1 when no samples have been recorded for the key
+    qint64 percentile(const QString& key, double p) const;
+
+private:
+    struct Window {
+        QVector<qint64> samples;
+        int next{0};
+    };
+    int m_windowSize;
+    QHash<QString, Window> m_windows;
+};
+
+// Classic three-state circuit breaker: after enough consecutive failures the
+// breaker opens and calls fail fast until the cooldown expires, then a single
+// probe is let through (half-open) to decide whether to close again.
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+
+    CircuitBreaker(int failureThreshold = 5, qint64 cooldownMs = 30000)
+        : m_failureThreshold(failureThreshold), m_cooldownMs(cooldownMs) {}
+
+    bool allowRequest();
+    void recordSuccess();
+    void recordFailure();
+    State state() const { return m_state; }
+
+private:
+    int m_failureThreshold;
+    qint64 m_cooldownMs;
+    int m_consecutiveFailures{0};
+    bool m_probeInFlight{false};
+    State m_state{State::Closed};
+    QElapsedTimer m_openedAt;
+};
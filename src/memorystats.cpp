@@ -0,0 +1,71 @@
+#include "memorystats.h"
+#include <QVariantList>
+#include <QDebug>
+#include "config.h"
+
+MemoryStats::MemoryStats(QObject* parent) : QObject(parent),
+    m_highWaterBytes(qint64(Config::getMemoryHighWaterMb()) * 1024 * 1024) {
+    m_timer.setInterval(5000);
+    connect(&m_timer, &QTimer::timeout, this, &MemoryStats::refresh);
+    m_timer.start();
+}
+
+void MemoryStats::addProbe(const QString& subsystem, Probe probe) {
+    m_probes.append({subsystem, std::move(probe)});
+}
+
+qint64 MemoryStats::approxBytes(const QVariant& value) {
+    switch (value.typeId()) {
+    case QMetaType::QString:
+        return approxBytes(value.toString());
+    case QMetaType::QByteArray:
+        return approxBytes(value.toByteArray());
+    case QMetaType::QVariantMap: {
+        const QVariantMap map = value.toMap();
+        qint64 bytes = 48;
+        for (auto it = map.cbegin(); it != map.cend(); ++it) bytes += approxBytes(it.key()) + approxBytes(it.value());
+        return bytes;
+    }
+    case QMetaType::QVariantList: {
+        qint64 bytes = 24;
+        for (const auto& v : value.toList()) bytes += approxBytes(v);
+        return bytes;
+    }
+    default:
+        return 16;
+    }
+}
+
+void MemoryStats::refresh() {
+    QVariantMap snapshot;
+    qint64 total = 0;
+    for (const auto& probe : m_probes) {
+        const QVariantMap parts = probe.second();
+        qint64 subtotal = 0;
+        for (const auto& v : parts) subtotal += v.toLongLong();
+        QVariantMap entry = parts;
+        entry["total"] = subtotal;
+        snapshot.insert(probe.first, entry);
+        total += subtotal;
+    }
+
+    // Data that can't be evicted (e.g. the visible conversation) may keep the
+    // total above the mark; evicting again on every tick would only throw away
+    // the passage and history caches. The next pass waits until the total has
+    // grown by a tenth of the mark beyond what the last one left.
+    if (total <= m_highWaterBytes) m_nextEvictionBytes = 0;
+    if (m_highWaterBytes > 0 && total > qMax(m_highWaterBytes, m_nextEvictionBytes) && m_evictor) {
+        const qint64 freed = m_evictor();
+        ++m_evictions;
+        m_evictedBytes += freed;
+        m_nextEvictionBytes = total - freed + m_highWaterBytes / 10;
+        qDebug() << "MemoryStats: Over high-water mark (" << total / 1024 << "KiB ), evicted ~" << freed / 1024 << "KiB";
+    }
+
+    snapshot["total"] = total;
+    snapshot["highWater"] = m_highWaterBytes;
+    snapshot["evictions"] = m_evictions;
+    snapshot["evictedBytes"] = m_evictedBytes;
+    m_snapshot = snapshot;
+    emit updated();
+}
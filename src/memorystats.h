@@ -0,0 +1,43 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QVariantMap>
+#include <functional>
+
+// Approximate memory accounting for the app's own data. Subsystems register a
+// probe returning {name: bytes}; the snapshot is refreshed periodically for the
+// debug overlay, and crossing the high-water mark asks for cold data to be
+// evicted (spilled to disk or dropped where it can be rebuilt).
+class MemoryStats : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap snapshot READ snapshot NOTIFY updated)
+public:
+    using Probe = std::function<QVariantMap()>;
+    using Evictor = std::function<qint64()>; // returns approximate bytes freed
+
+    explicit MemoryStats(QObject* parent=nullptr);
+
+    void addProbe(const QString& subsystem, Probe probe);
+    void setEvictor(Evictor evictor) { m_evictor = std::move(evictor); }
+
+    QVariantMap snapshot() const { return m_snapshot; }
+    Q_INVOKABLE void refresh();
+
+    // Rough heap footprint of values as Conversation stores them
+    static qint64 approxBytes(const QVariant& value);
+    static qint64 approxBytes(const QString& s) { return 24 + s.capacity() * 2; }
+    static qint64 approxBytes(const QByteArray& b) { return 24 + b.capacity(); }
+
+signals:
+    void updated();
+
+private:
+    QList<QPair<QString, Probe>> m_probes;
+    Evictor m_evictor;
+    QVariantMap m_snapshot;
+    QTimer m_timer;
+    qint64 m_highWaterBytes;
+    qint64 m_nextEvictionBytes{0}; // total needed before evicting again, 0 once back under the mark
+    int m_evictions{0};
+    qint64 m_evictedBytes{0};
+};
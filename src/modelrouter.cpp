@@ -0,0 +1,84 @@
+#include "modelrouter.h"
+#include <QRegularExpression>
+#include <QDebug>
+#include "config.h"
+
+namespace {
+constexpr double kAlpha = 0.2;          // EWMA weight of the newest sample
+constexpr int kMinSamples = 3;          // before latency can override feature rules
+constexpr int kShortQueryChars = 120;
+constexpr int kLongQueryChars = 300;
+// If the strong model's first token is this much slower, medium queries take the fast route
+constexpr double kSlowStrongRatio = 2.0;
+// Every Nth medium query diverted for that reason still goes to the strong
+// model, so its timing keeps updating and the diversion can end
+constexpr int kExploreEvery = 8;
+}
+
+ModelRouter::ModelRouter()
+    : m_fastModel(Config::getFastModel()),
+      m_strongModel(Config::getStrongModel()),
+      m_override(Config::getModelOverride()) {}
+
+ModelRouter::Features ModelRouter::featuresFor(const QString& query) {
+    static const QRegularExpression analytical(
+        "\\b(compare|comparison|versus|vs\\.?|why|explain|analy[sz]e|forecast|predict|impact|correlat\\w*|trade-?offs?)\\b",
+        QRegularExpression::CaseInsensitiveOption);
+    const QString lower = query.toLower();
+
+    Features f;
+    f.queryLength = query.size();
+    f.fromTheme = query.startsWith("Search for statistics about") ||
+                  query.startsWith("Tell me about statistics related to");
+    f.toolsLikely = lower.contains("statist") || lower.contains("data") || lower.contains("tell me about");
+    f.analytical = analytical.match(query).hasMatch();
+    return f;
+}
+
+ModelRouter::Route ModelRouter::route(const Features& f) const {
+    if (!m_override.isEmpty()) return {m_override, "override"};
+
+    if (f.fromTheme) return {m_fastModel, "theme query"};
+    if (f.analytical || f.queryLength > kLongQueryChars) return {m_strongModel, "complex query"};
+    if (f.queryLength <= kShortQueryChars && !f.toolsLikely) return {m_fastModel, "short query"};
+
+    // Medium-sized questions: let measured latency break the tie
+    const Timing fast = m_timings.value(m_fastModel);
+    const Timing strong = m_timings.value(m_strongModel);
+    if (fast.samples >= kMinSamples && strong.samples >= kMinSamples &&
+        strong.ttftMs > kSlowStrongRatio * fast.ttftMs) {
+        if (++m_diverted < kExploreEvery) {
+            return {m_fastModel, QString("strong model slow (TTFT %1 ms)").arg(qRound(strong.ttftMs))};
+        }
+        m_diverted = 0;
+        return {m_strongModel, "re-measuring strong model"};
+    }
+    m_diverted = 0;
+    return {m_strongModel, "default"};
+}
+
+void ModelRouter::recordTiming(const QString& model, qint64 ttftMs, qint64 totalMs) {
+    Timing& t = m_timings[model];
+    if (t.samples == 0) {
+        t.ttftMs = ttftMs;
+        t.totalMs = totalMs;
+    } else {
+        t.ttftMs += kAlpha * (ttftMs - t.ttftMs);
+        t.totalMs += kAlpha * (totalMs - t.totalMs);
+    }
+    ++t.samples;
+    qDebug() << "ModelRouter:" << model << "TTFT" << ttftMs << "ms, total" << totalMs
+             << "ms (avg" << qRound(t.ttftMs) << "/" << qRound(t.totalMs) << ")";
+}
+
+QVariantMap ModelRouter::stats() const {
+    QVariantMap out;
+    for (auto it = m_timings.cbegin(); it != m_timings.cend(); ++it) {
+        out.insert(it.key(), QVariantMap{
+            {"ttftMs", qRound(it->ttftMs)},
+            {"totalMs", qRound(it->totalMs)},
+            {"samples", it->samples}
+        });
+    }
+    return out;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QVariantMap>
+
+// Picks the Claude model for each chat turn from cheap query features and the
+// rolling latency observed per model. Theme-chip and short lookups go to the
+// fast model; long or analytical questions go to the strong one.
+class ModelRouter {
+public:
+    struct Features {
+        int queryLength{0};
+        bool fromTheme{false};   // built from a theme chip / sendThemeQuery
+        bool toolsLikely{false}; // question asks for data, so the tool loop will run
+        bool analytical{false};  // compare / explain / forecast style wording
+    };
+    struct Route {
+        QString model;
+        QString reason;
+    };
+
+    ModelRouter();
+
+    static Features featuresFor(const QString& query);
+    Route route(const Features& f) const;
+    void recordTiming(const QString& model, qint64 ttftMs, qint64 totalMs);
+    QVariantMap stats() const;
+
+    QString fastModel() const { return m_fastModel; }
+    QString strongModel() const { return m_strongModel; }
+
+private:
+    struct Timing {
+        double ttftMs{0};
+        double totalMs{0};
+        int samples{0};
+    };
+
+    QString m_fastModel;
+    QString m_strongModel;
+    QString m_override;
+    QHash<QString, Timing> m_timings;
+    // Medium queries sent to the fast model since the strong one was last tried
+    mutable int m_diverted{0};
+};
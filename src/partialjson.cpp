@@ -0,0 +1,93 @@
+#include "partialjson.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+
+namespace {
+// Parse a single JSON value by wrapping it in an array
+bool parseValue(const QString& raw, QJsonValue* out) {
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(("[" + raw + "]").toUtf8(), &err);
+    if (err.error != QJsonParseError::NoError || doc.array().size() != 1) return false;
+    *out = doc.array().at(0);
+    return true;
+}
+}
+
+void PartialJsonObject::reset() {
+    *this = PartialJsonObject();
+}
+
+void PartialJsonObject::feed(const QString& chunk) {
+    m_text.append(chunk);
+    for (; m_pos < m_text.size() && !m_closed; ++m_pos) {
+        const QChar c = m_text.at(m_pos);
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                if (m_depth != 1) continue;
+                if (m_phase == Phase::Key) {
+                    QJsonValue key;
+                    if (parseValue(m_text.mid(m_tokenStart, m_pos - m_tokenStart + 1), &key)) m_key = key.toString();
+                    m_phase = Phase::Colon;
+                } else if (m_phase == Phase::Value) {
+                    finishValue(m_pos + 1);
+                }
+            }
+            continue;
+        }
+
+        switch (c.unicode()) {
+        case '"':
+            m_inString = true;
+            if (m_depth == 1 && m_phase == Phase::Key) m_tokenStart = m_pos;
+            else if (m_depth == 1 && m_phase == Phase::Value && m_valueStart < 0) m_valueStart = m_pos;
+            break;
+        case '{':
+        case '[':
+            if (m_depth == 1 && m_phase == Phase::Value && m_valueStart < 0) m_valueStart = m_pos;
+            ++m_depth;
+            break;
+        case '}':
+        case ']':
+            --m_depth;
+            if (m_depth == 1 && m_phase == Phase::Value) {
+                finishValue(m_pos + 1);
+            } else if (m_depth == 0) {
+                if (m_phase == Phase::Value && m_valueStart >= 0) finishValue(m_pos);
+                m_closed = true;
+            }
+            break;
+        case ':':
+            if (m_depth == 1 && m_phase == Phase::Colon) m_phase = Phase::Value;
+            break;
+        case ',':
+            if (m_depth != 1) break;
+            if (m_phase == Phase::Value && m_valueStart >= 0) finishValue(m_pos);
+            m_phase = Phase::Key;
+            break;
+        default:
+            if (m_depth == 1 && m_phase == Phase::Value && m_valueStart < 0 && !c.isSpace()) m_valueStart = m_pos;
+        }
+    }
+}
+
+void PartialJsonObject::finishValue(qsizetype end) {
+    QJsonValue value;
+    if (!m_key.isEmpty() && parseValue(m_text.mid(m_valueStart, end - m_valueStart).trimmed(), &value)) {
+        m_members.insert(m_key, value);
+    }
+    m_valueStart = -1;
+    m_key.clear();
+    m_phase = Phase::AfterValue;
+}
+
+bool PartialJsonObject::hasAll(const QStringList& keys) const {
+    for (const auto& key : keys) {
+        if (!m_members.contains(key)) return false;
+    }
+    return true;
+}
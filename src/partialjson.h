@@ -0,0 +1,34 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QJsonObject>
+
+// Incremental scanner for a JSON object that arrives in fragments (Claude's
+// input_json_delta). Each top-level member is reported as soon as its value is
+// complete: a string once its closing quote arrives, a nested value once its
+// bracket closes, a number or literal once the following ',' or '}' arrives.
+class PartialJsonObject {
+public:
+    void reset();
+    void feed(const QString& chunk);
+
+    const QJsonObject& members() const { return m_members; }
+    bool hasAll(const QStringList& keys) const;
+    bool isClosed() const { return m_closed; }
+
+private:
+    enum class Phase { Key, Colon, Value, AfterValue };
+    void finishValue(qsizetype end);
+
+    QString m_text;
+    qsizetype m_pos{0};
+    int m_depth{0};
+    bool m_inString{false};
+    bool m_escape{false};
+    bool m_closed{false};
+    Phase m_phase{Phase::Key};
+    qsizetype m_tokenStart{-1};
+    qsizetype m_valueStart{-1};
+    QString m_key;
+    QJsonObject m_members;
+};
@@ -0,0 +1,94 @@
+#include "passageretriever.h"
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Target passage size in characters (~150 tokens)
+constexpr int kPassageChars = 600;
+}
+
+QStringList PassageRetriever::chunk(const QString& text) {
+    static const QRegularExpression sentenceEnd("(?<=[.!?])\\s+");
+    QStringList passages;
+    QString current;
+    auto flush = [&]() {
+        QString p = current.simplified();
+        if (p.size() > 20) passages << p;
+        current.clear();
+    };
+
+    for (const QString& rawLine : text.split('\n', Qt::SkipEmptyParts)) {
+        const QString line = rawLine.trimmed();
+        if (line.isEmpty()) continue;
+        // Overlong lines (no newlines on the page) get split on sentence boundaries
+        const QStringList pieces = line.size() > kPassageChars ? line.split(sentenceEnd, Qt::SkipEmptyParts)
+                                                               : QStringList{line};
+        for (const QString& piece : pieces) {
+            if (!current.isEmpty() && current.size() + piece.size() > kPassageChars) flush();
+            if (!current.isEmpty()) current += ' ';
+            current += piece;
+        }
+    }
+    flush();
+    return passages;
+}
+
+std::shared_ptr<PassageRetriever::Page> PassageRetriever::pageFor(const QString& text) {
+    const QByteArray key = QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1);
+    auto it = m_pages.constFind(key);
+    if (it != m_pages.constEnd()) {
+        m_lru.removeOne(key);
+        m_lru.append(key);
+        return *it;
+    }
+
+    auto page = std::make_shared<Page>();
+    page->passages = chunk(text);
+    for (const QString& p : page->passages) page->index.addDocument(p);
+    qDebug() << "PassageRetriever: Indexed page into" << page->passages.size() << "passages";
+
+    m_pages.insert(key, page);
+    m_lru.append(key);
+    while (m_lru.size() > m_maxCachedPages) m_pages.remove(m_lru.takeFirst());
+    return page;
+}
+
+QStringList PassageRetriever::retrieve(const QString& pageText, const QString& question, int tokenBudget, int topK) {
+    if (pageText.trimmed().isEmpty() || tokenBudget <= 0 || topK <= 0) return {};
+    auto page = pageFor(pageText);
+
+    QList<int> chosen;
+    int used = 0;
+    for (const auto& hit : page->index.search(question, topK)) {
+        int cost = estimateTokens(page->passages.at(hit.doc));
+        if (used + cost > tokenBudget) continue; // a smaller passage further down may still fit
+        used += cost;
+        chosen << hit.doc;
+    }
+    // Generic questions ("summarize this page") match few or no terms; the
+    // rest of the budget goes to the start of the page, as before retrieval
+    for (int doc = 0; doc < page->passages.size() && chosen.size() < topK; ++doc) {
+        if (chosen.contains(doc)) continue;
+        int cost = estimateTokens(page->passages.at(doc));
+        if (used + cost > tokenBudget) break;
+        used += cost;
+        chosen << doc;
+    }
+    std::sort(chosen.begin(), chosen.end());
+
+    QStringList out;
+    for (int doc : chosen) out << page->passages.at(doc);
+    return out;
+}
+
+qint64 PassageRetriever::approxBytes() const {
+    qint64 bytes = 0;
+    for (const auto& page : m_pages) {
+        // Passage text plus the BM25 postings and term lists, which come to
+        // about twice the text again
+        for (const QString& p : page->passages) bytes += p.size() * 2 * 3;
+    }
+    return bytes;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <memory>
+#include "bm25index.h"
+
+// Chunks page text into passages and picks the ones most relevant to a question,
+// within a token budget. Chunked/indexed pages are cached by content hash so
+// repeat questions on the same page skip the indexing work.
+class PassageRetriever {
+public:
+    explicit PassageRetriever(int maxCachedPages = 8) : m_maxCachedPages(maxCachedPages) {}
+
+    // Returns the selected passages in page order; leading passages fill in
+    // when too few match the question
+    QStringList retrieve(const QString& pageText, const QString& question, int tokenBudget, int topK);
+
+    // Rough token estimate (~4 characters per token for English text)
+    static int estimateTokens(const QString& text) { return (text.size() + 3) / 4; }
+
+    // Rough heap footprint of the cached pages; clear() drops them (they are rebuilt on demand)
+    qint64 approxBytes() const;
+    int cachedPages() const { return m_pages.size(); }
+    void clear() { m_pages.clear(); m_lru.clear(); }
+
+private:
+    struct Page {
+        QStringList passages;
+        Bm25Index index;
+    };
+
+    static QStringList chunk(const QString& text);
+    std::shared_ptr<Page> pageFor(const QString& text);
+
+    int m_maxCachedPages;
+    QHash<QByteArray, std::shared_ptr<Page>> m_pages;
+    QList<QByteArray> m_lru; // most recently used last
+};
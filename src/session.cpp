@@ -1 +1,196 @@
-/* no-op */
+#include "session.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace {
+constexpr quint32 kMagic = 0x534A4E4C; // "SJNL"
+constexpr quint32 kVersion = 1;
+constexpr int kCompactSlack = 64; // journal records tolerated beyond one per tab
+}
+
+Session::Session(QObject* parent) : QObject(parent),
+    m_path(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/session.journal") {
+    load();
+}
+
+QString Session::newKey(int serial) {
+    return QString("tab-%1-%2").arg(QString::number(QDateTime::currentMSecsSinceEpoch(), 36)).arg(serial);
+}
+
+void Session::load() {
+    QFile f(m_path);
+    if (!f.exists()) {
+        // First run with a journal: carry over the tabs of the old QSettings format.
+        // The header is written even with nothing to migrate, so records appended
+        // before the first clean exit still replay after a crash
+        migrateSettings();
+        compact();
+        return;
+    }
+    if (!f.open(QIODevice::ReadWrite)) {
+        qDebug() << "Session: Cannot open" << m_path;
+        return;
+    }
+
+    QDataStream in(&f);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        qDebug() << "Session: Ignoring incompatible journal" << m_path;
+        f.close();
+        compact();
+        return;
+    }
+
+    qint64 good = f.pos();
+    while (!in.atEnd()) {
+        quint8 type = 0;
+        qint32 index = 0;
+        QString a, b;
+        in >> type >> index >> a >> b;
+        if (in.status() != QDataStream::Ok) break;
+        if (!apply(Event(type), index, a, b)) {
+            qDebug() << "Session: Skipping inconsistent journal record" << type << index;
+        }
+        ++m_events;
+        good = f.pos();
+    }
+    if (good < f.size()) {
+        qDebug() << "Session: Dropping truncated tail of" << m_path;
+        f.resize(good);
+    }
+    f.close();
+
+    // Tabs from an older build may lack a conversation key
+    bool rekeyed = false;
+    for (int i = 0; i < m_tabs.size(); ++i) {
+        if (m_tabs[i].key.isEmpty()) { m_tabs[i].key = newKey(i); rekeyed = true; }
+    }
+    m_activeIndex = qBound(0, m_activeIndex, qMax(0, int(m_tabs.size()) - 1));
+    qDebug() << "Session: Restored" << m_tabs.size() << "tabs from" << m_events << "journal records";
+    if (rekeyed || m_events > m_tabs.size() * 2 + kCompactSlack) compact();
+}
+
+bool Session::migrateSettings() {
+    QSettings s;
+    const int size = s.beginReadArray("tabs");
+    for (int i = 0; i < size; ++i) {
+        s.setArrayIndex(i);
+        Tab t;
+        t.url = s.value("url").toString();
+        t.key = s.value("key").toString();
+        if (t.key.isEmpty()) t.key = newKey(i);
+        if (!t.url.isEmpty()) m_tabs.append(t);
+    }
+    s.endArray();
+    m_activeIndex = qBound(0, s.value("activeIndex", 0).toInt(), qMax(0, int(m_tabs.size()) - 1));
+    return size > 0;
+}
+
+bool Session::apply(Event type, qint32 index, const QString& a, const QString& b) {
+    const bool valid = index >= 0 && index < m_tabs.size();
+    switch (type) {
+    case Event::Add:
+        if (index < 0 || index > m_tabs.size()) return false;
+        m_tabs.insert(index, Tab{a, b, QString()});
+        return true;
+    case Event::Close:
+        if (!valid) return false;
+        m_tabs.remove(index);
+        return true;
+    case Event::Move: {
+        const int to = a.toInt();
+        if (!valid || to < 0 || to >= m_tabs.size()) return false;
+        m_tabs.move(index, to);
+        return true;
+    }
+    case Event::Navigate:
+        if (!valid) return false;
+        m_tabs[index].url = a;
+        return true;
+    case Event::Retitle:
+        if (!valid) return false;
+        m_tabs[index].title = a;
+        return true;
+    case Event::Activate:
+        m_activeIndex = index;
+        return true;
+    }
+    return false;
+}
+
+void Session::append(Event type, qint32 index, const QString& a, const QString& b) {
+    if (!apply(type, index, a, b)) {
+        qDebug() << "Session: Ignoring out of range tab event" << quint8(type) << index;
+        return;
+    }
+    QFile f(m_path);
+    if (!f.exists()) {
+        // Deleted or never written (e.g. an unwritable directory at startup):
+        // a snapshot already contains this event and starts with the header
+        compact();
+        return;
+    }
+    if (!f.open(QIODevice::Append)) {
+        qDebug() << "Session: Cannot append to" << m_path;
+        return;
+    }
+    QDataStream out(&f);
+    out << quint8(type) << index << a << b;
+    f.close();
+    if (++m_events > m_tabs.size() * 2 + kCompactSlack) compact();
+}
+
+QVariantList Session::restoredTabs() const {
+    QVariantList tabs;
+    for (const Tab& t : m_tabs) {
+        tabs << QVariantMap{{"url", t.url}, {"title", t.title}, {"key", t.key}};
+    }
+    return tabs;
+}
+
+void Session::tabAdded(int index, const QString& key, const QString& url) { append(Event::Add, index, key, url); }
+void Session::tabClosed(int index) { append(Event::Close, index); }
+void Session::tabMoved(int from, int to) { append(Event::Move, from, QString::number(to)); }
+
+void Session::tabNavigated(int index, const QString& url) {
+    if (index >= 0 && index < m_tabs.size() && m_tabs.at(index).url == url) return;
+    append(Event::Navigate, index, url);
+}
+
+void Session::tabRetitled(int index, const QString& title) {
+    if (index >= 0 && index < m_tabs.size() && m_tabs.at(index).title == title) return;
+    append(Event::Retitle, index, title);
+}
+
+void Session::tabActivated(int index) {
+    if (index == m_activeIndex) return;
+    append(Event::Activate, index);
+}
+
+bool Session::compact() {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile f(m_path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "Session: Cannot write" << m_path;
+        return false;
+    }
+    QDataStream out(&f);
+    out << kMagic << kVersion;
+    for (int i = 0; i < m_tabs.size(); ++i) {
+        const Tab& t = m_tabs.at(i);
+        out << quint8(Event::Add) << qint32(i) << t.key << t.url;
+        if (!t.title.isEmpty()) out << quint8(Event::Retitle) << qint32(i) << t.title << QString();
+    }
+    out << quint8(Event::Activate) << qint32(m_activeIndex) << QString() << QString();
+    if (!f.commit()) return false;
+    m_events = 0;
+    return true;
+}
@@ -1,42 +1,48 @@
 #pragma once
 #include <QObject>
 #include <QStringList>
-#include <QSettings>
+#include <QVariantList>
+#include <QVector>
 
+// Tab session state, kept as an append-only journal of tab events (add, close,
+// move, navigate, retitle, activate) so each change costs one small append
+// instead of rewriting every tab. The journal is replayed at startup and
+// compacted to a snapshot once it grows well past the number of open tabs.
 class Session : public QObject {
     Q_OBJECT
 public:
-    explicit Session(QObject* parent=nullptr) : QObject(parent) {}
+    explicit Session(QObject* parent=nullptr);
 
-    Q_INVOKABLE QStringList loadTabs() const {
-        QSettings s;
-        int size = s.beginReadArray("tabs");
-        QStringList urls;
-        for (int i=0;i<size;++i) {
-            s.setArrayIndex(i);
-            urls << s.value("url").toString();
-        }
-        s.endArray();
-        if (urls.isEmpty()) {
-            urls << "https://example.com";
-        }
-        return urls;
-    }
+    // Tabs of the last session as [{url, title, key}], in tab order
+    Q_INVOKABLE QVariantList restoredTabs() const;
+    Q_INVOKABLE int loadActiveIndex() const { return m_activeIndex; }
 
-    Q_INVOKABLE int loadActiveIndex() const {
-        QSettings s;
-        return s.value("activeIndex", 0).toInt();
-    }
+    Q_INVOKABLE void tabAdded(int index, const QString& key, const QString& url);
+    Q_INVOKABLE void tabClosed(int index);
+    Q_INVOKABLE void tabMoved(int from, int to);
+    Q_INVOKABLE void tabNavigated(int index, const QString& url);
+    Q_INVOKABLE void tabRetitled(int index, const QString& title);
+    Q_INVOKABLE void tabActivated(int index);
 
-    Q_INVOKABLE void saveTabs(const QStringList& urls, int activeIndex) {
-        QSettings s;
-        s.beginWriteArray("tabs");
-        for (int i=0;i<urls.size();++i) {
-            s.setArrayIndex(i);
-            s.setValue("url", urls.at(i));
-        }
-        s.endArray();
-        s.setValue("activeIndex", activeIndex);
-        s.sync();
-    }
-};
\ No newline at end of file
+    // Rewrite the journal as a snapshot of the current tabs
+    Q_INVOKABLE bool compact();
+
+private:
+    enum class Event : quint8 { Add = 1, Close, Move, Navigate, Retitle, Activate };
+    struct Tab {
+        QString key;
+        QString url;
+        QString title;
+    };
+
+    void load();
+    bool migrateSettings();
+    void append(Event type, qint32 index, const QString& a = QString(), const QString& b = QString());
+    bool apply(Event type, qint32 index, const QString& a, const QString& b);
+    static QString newKey(int serial);
+
+    QString m_path;
+    QVector<Tab> m_tabs;
+    int m_activeIndex{0};
+    int m_events{0}; // records in the journal since the last snapshot
+};
@@ -0,0 +1,81 @@
+#include "startuptrace.h"
+#include <QQuickWindow>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QCoreApplication>
+#include <QDebug>
+#include "config.h"
+
+StartupTrace::StartupTrace(QObject* parent) : QObject(parent) {
+    m_clock.start();
+}
+
+void StartupTrace::begin(const QString& phase) {
+    m_open.insert(phase, m_events.size());
+    m_events.append({phase, nowUs(), 0});
+}
+
+void StartupTrace::end(const QString& phase) {
+    if (!m_open.contains(phase)) return;
+    const int index = m_open.take(phase);
+    Event& e = m_events[index];
+    e.durationUs = nowUs() - e.startUs;
+    qDebug() << "StartupTrace:" << phase << "took" << e.durationUs / 1000.0 << "ms";
+}
+
+void StartupTrace::mark(const QString& event) {
+    m_events.append({event, nowUs(), -1});
+    qDebug() << "StartupTrace:" << event << "at" << m_events.last().startUs / 1000.0 << "ms";
+}
+
+void StartupTrace::watchFirstFrame(QQuickWindow* window) {
+    if (!window) return;
+    // frameSwapped comes from the render thread; handle it on ours, once
+    connect(window, &QQuickWindow::frameSwapped, this, [this](){
+        if (firstFrameShown()) return;
+        mark("first frame");
+        m_firstFrameUs = m_events.last().startUs;
+        emit firstFrame();
+    }, Qt::ConnectionType(Qt::QueuedConnection | Qt::SingleShotConnection));
+}
+
+bool StartupTrace::write(const QString& path) const {
+    const QString target = !path.isEmpty() ? path
+        : Config::getConfigValue("STARTUP_TRACE_FILE",
+                                 QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/startup-trace.json");
+    QJsonArray events;
+    const qint64 pid = QCoreApplication::applicationPid();
+    for (const Event& e : m_events) {
+        QJsonObject o{
+            {"name", e.name},
+            {"cat", "startup"},
+            {"ts", e.startUs},
+            {"pid", pid},
+            {"tid", 1}
+        };
+        if (e.durationUs < 0) {
+            o["ph"] = "i";
+            o["s"] = "g";
+        } else {
+            o["ph"] = "X";
+            o["dur"] = e.durationUs;
+        }
+        events.append(o);
+    }
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    QSaveFile f(target);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "StartupTrace: Cannot write" << target;
+        return false;
+    }
+    f.write(QJsonDocument(QJsonObject{{"traceEvents", events}, {"displayTimeUnit", "ms"}}).toJson(QJsonDocument::Compact));
+    if (!f.commit()) return false;
+    qDebug() << "StartupTrace: First frame after" << m_firstFrameUs / 1000.0 << "ms, trace written to" << target;
+    return true;
+}
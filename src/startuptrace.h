@@ -0,0 +1,55 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+class QQuickWindow;
+
+// Times the startup critical path: each phase from process start to the first
+// frame, and the work deferred until after it. The result is written as a
+// Chrome trace-event file (open in chrome://tracing or Perfetto). QML marks its
+// own phases through the "startup" context property and restores background
+// tabs on firstFrame.
+class StartupTrace : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool firstFrameShown READ firstFrameShown NOTIFY firstFrame)
+public:
+    // Scoped phase for C++ callers
+    class Span {
+    public:
+        Span(StartupTrace& trace, const QString& phase) : m_trace(trace), m_phase(phase) { m_trace.begin(m_phase); }
+        ~Span() { m_trace.end(m_phase); }
+    private:
+        StartupTrace& m_trace;
+        QString m_phase;
+    };
+
+    explicit StartupTrace(QObject* parent=nullptr);
+
+    Q_INVOKABLE void begin(const QString& phase);
+    Q_INVOKABLE void end(const QString& phase);
+    Q_INVOKABLE void mark(const QString& event);
+    bool firstFrameShown() const { return m_firstFrameUs >= 0; }
+    // Emits firstFrame once the window has presented its first frame
+    void watchFirstFrame(QQuickWindow* window);
+    // STARTUP_TRACE_FILE, or startup-trace.json in the app data directory
+    bool write(const QString& path = QString()) const;
+
+signals:
+    void firstFrame();
+
+private:
+    struct Event {
+        QString name;
+        qint64 startUs{0};
+        qint64 durationUs{-1}; // -1 for an instant event
+    };
+
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+
+    QElapsedTimer m_clock;
+    QHash<QString, int> m_open; // phase name -> index in m_events
+    QList<Event> m_events;
+    qint64 m_firstFrameUs{-1};
+};
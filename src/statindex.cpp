@@ -0,0 +1,182 @@
+#include "statindex.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QDebug>
+#include <utility>
+
+namespace {
+constexpr quint32 kMagic = 0x53544958; // "STIX"
+constexpr quint32 kVersion = 1;
+}
+
+StatIndex::StatIndex(const QString& path) : m_path(path) {}
+
+bool StatIndex::load() {
+    QFile f(m_path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&f);
+    quint32 magic = 0, version = 0, count = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) {
+        qDebug() << "StatIndex: Ignoring incompatible index file" << m_path;
+        return false;
+    }
+    in >> count;
+
+    m_records.clear();
+    m_byKey.clear();
+    m_index.clear();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Record r;
+        in >> r.id >> r.title >> r.summary >> r.link >> r.lastSeen;
+        int doc = m_index.addDocument(indexText(r));
+        m_records.append(r);
+        m_byKey.insert(r.id.isEmpty() ? r.link : r.id, doc);
+    }
+    m_dirty = false;
+    qDebug() << "StatIndex: Loaded" << m_records.size() << "statistics from" << m_path;
+    return in.status() == QDataStream::Ok;
+}
+
+bool StatIndex::save() {
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    QSaveFile f(m_path);
+    if (!f.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&f);
+    out << kMagic << kVersion << quint32(m_byKey.size());
+    for (int doc : std::as_const(m_byKey)) {
+        const Record& r = m_records.at(doc);
+        out << r.id << r.title << r.summary << r.link << r.lastSeen;
+    }
+    if (!f.commit()) return false;
+    m_dirty = false;
+    return true;
+}
+
+bool StatIndex::addItem(const QJsonObject& item, qint64 now) {
+    Record r;
+    r.title = item.value("title").toString();
+    r.link = item.contains("link") ? item.value("link").toString() : item.value("url").toString();
+    r.summary = item.contains("summary") ? item.value("summary").toString() : item.value("description").toString();
+    r.id = item.value("id").toVariant().toString();
+    r.lastSeen = now;
+    if (r.title.isEmpty() || (r.id.isEmpty() && r.link.isEmpty())) return false;
+
+    const QString key = r.id.isEmpty() ? r.link : r.id;
+    auto existing = m_byKey.constFind(key);
+    if (existing != m_byKey.constEnd()) {
+        Record& old = m_records[*existing];
+        // Same text: only refresh metadata, no reindex
+        if (old.title == r.title && (r.summary.isEmpty() || old.summary == r.summary)) {
+            old.lastSeen = now;
+            if (old.link.isEmpty() && !r.link.isEmpty()) old.link = r.link;
+            // Recency is persisted too
+            m_dirty = true;
+            return false;
+        }
+        // Changed text: replace the record and its postings in place
+        if (r.summary.isEmpty()) r.summary = old.summary;
+        if (r.link.isEmpty()) r.link = old.link;
+        old = r;
+        m_index.replaceDocument(*existing, indexText(r));
+        m_dirty = true;
+        return true;
+    }
+
+    int doc = m_index.addDocument(indexText(r));
+    m_records.append(r);
+    m_byKey.insert(key, doc);
+    m_dirty = true;
+    return true;
+}
+
+int StatIndex::addItems(const QJsonArray& items) {
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    int added = 0;
+    for (const auto& v : items) {
+        if (v.isObject() && addItem(v.toObject(), now)) ++added;
+    }
+    return added;
+}
+
+int StatIndex::addToolResponse(const QJsonObject& response) {
+    // Older servers return the items directly instead of MCP content
+    const QJsonValue result = response.value("result");
+    if (result.isArray()) return addItems(result.toArray());
+    if (result.toObject().value("items").isArray()) return addItems(result.toObject().value("items").toArray());
+
+    const auto content = result.toObject().value("content").toArray();
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    int added = 0;
+    for (const auto& c : content) {
+        const auto text = c.toObject().value("text");
+        QJsonObject payload = text.isObject() ? text.toObject()
+                                              : QJsonDocument::fromJson(text.toString().toUtf8()).object();
+        // Content items may also carry the data arrays themselves
+        if (payload.isEmpty()) payload = c.toObject();
+        // Chart data responses describe a single statistic
+        if (payload.contains("title") && payload.contains("link") && addItem(payload, now)) ++added;
+        for (const char* key : {"items", "statistics", "data", "results"}) {
+            if (payload.value(key).isArray()) added += addItems(payload.value(key).toArray());
+        }
+    }
+    return added;
+}
+
+QString StatIndex::indexText(const Record& r) {
+    // The id is searchable as a word; links only match exactly (see search())
+    return r.title + ' ' + r.summary + ' ' + r.id;
+}
+
+QVector<StatIndex::Record> StatIndex::search(const QString& query, int limit) const {
+    QVector<Record> out;
+    if (limit <= 0) return out;
+    // A statistic id or link pasted as the query is an exact hit
+    const auto exact = m_byKey.constFind(query.trimmed());
+    if (exact != m_byKey.constEnd()) out.append(m_records.at(*exact));
+    for (const auto& hit : m_index.search(query, limit)) {
+        if (out.size() >= limit) break;
+        if (exact != m_byKey.constEnd() && hit.doc == *exact) continue;
+        out.append(m_records.at(hit.doc));
+    }
+    return out;
+}
+
+QVariantMap StatIndex::toVariant(const Record& r) {
+    QVariantMap m;
+    m["title"] = r.title;
+    m["url"] = r.link;
+    m["id"] = r.id;
+    m["summary"] = r.summary;
+    m["source"] = "local";
+    return m;
+}
+
+QJsonObject StatIndex::toToolResponse(const QVector<Record>& records) {
+    QJsonArray items;
+    for (const Record& r : records) {
+        items.append(QJsonObject{
+            {"id", r.id},
+            {"title", r.title},
+            {"summary", r.summary},
+            {"link", r.link}
+        });
+    }
+    QJsonObject text{
+        {"items", items},
+        {"note", "Offline results from the local index; the live Statista search was unavailable."}
+    };
+    return QJsonObject{
+        {"result", QJsonObject{
+            {"content", QJsonArray{QJsonObject{
+                {"type", "text"},
+                {"text", QString::fromUtf8(QJsonDocument(text).toJson(QJsonDocument::Compact))}
+            }}}
+        }}
+    };
+}
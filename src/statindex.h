@@ -0,0 +1,50 @@
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVariantMap>
+#include "bm25index.h"
+
+// Local, persisted full-text index of every Statista statistic we have seen in
+// search-statistics / get-chart-data-by-id results. Used for instant provisional
+// results and as an offline fallback when the MCP endpoint is slow or down.
+class StatIndex {
+public:
+    struct Record {
+        QString id;
+        QString title;
+        QString summary;
+        QString link;
+        qint64 lastSeen{0};
+    };
+
+    explicit StatIndex(const QString& path);
+
+    bool load();
+    bool save();
+    bool isDirty() const { return m_dirty; }
+    int size() const { return m_index.documentCount(); }
+
+    // Index items from a raw array of statistic objects (title/summary/id/link|url)
+    int addItems(const QJsonArray& items);
+    // Index whatever statistics a tools/call JSON-RPC response carries
+    int addToolResponse(const QJsonObject& response);
+
+    QVector<Record> search(const QString& query, int limit) const;
+
+    static QVariantMap toVariant(const Record& r);
+    // Shape local hits like a search-statistics tool result so Claude can consume them
+    static QJsonObject toToolResponse(const QVector<Record>& records);
+
+private:
+    bool addItem(const QJsonObject& item, qint64 now);
+    static QString indexText(const Record& r);
+
+    QString m_path;
+    QVector<Record> m_records;     // index == Bm25Index document id; updated in place
+    QHash<QString, int> m_byKey;   // statistic id (or link) -> document id
+    Bm25Index m_index;
+    bool m_dirty{false};
+};
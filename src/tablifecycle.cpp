@@ -0,0 +1,138 @@
+#include "tablifecycle.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include "config.h"
+
+TabLifecycle::TabLifecycle(QObject* parent) : QObject(parent),
+    m_freezeMs(qint64(Config::getTabFreezeAfterSeconds()) * 1000),
+    m_discardMs(qint64(Config::getTabDiscardAfterSeconds()) * 1000),
+    m_budgetMb(Config::getTabMemoryBudgetMb()),
+    m_tabEstimateMb(qMax(1, Config::getTabEstimatedMb())) {
+    m_clock.start();
+    m_timer.setInterval(15000);
+    connect(&m_timer, &QTimer::timeout, this, &TabLifecycle::evaluate);
+    m_timer.start();
+}
+
+void TabLifecycle::registerTab(const QString& key, const QString& url, bool discarded) {
+    Tab& tab = m_tabs[key];
+    tab.url = url;
+    tab.state = discarded ? Discarded : Active;
+    tab.lastActiveMs = m_clock.elapsed();
+    // New tabs may push the live set over budget
+    if (!discarded) QTimer::singleShot(0, this, &TabLifecycle::evaluate);
+}
+
+void TabLifecycle::unregisterTab(const QString& key) {
+    m_tabs.remove(key);
+    if (m_activeKey == key) m_activeKey.clear();
+}
+
+void TabLifecycle::activate(const QString& key) {
+    auto it = m_tabs.find(key);
+    if (it == m_tabs.end()) return;
+    if (auto prev = m_tabs.find(m_activeKey); prev != m_tabs.end()) {
+        // Idle time of the tab being left counts from now
+        prev->lastActiveMs = m_clock.elapsed();
+    }
+    m_activeKey = key;
+    it->lastActiveMs = m_clock.elapsed();
+    if (it->state != Active) transition(key, *it, Active);
+    QTimer::singleShot(0, this, &TabLifecycle::evaluate);
+}
+
+void TabLifecycle::recordUrl(const QString& key, const QString& url) {
+    auto it = m_tabs.find(key);
+    if (it == m_tabs.end() || it->url == url) return;
+    it->url = url;
+    // A different page: the old scroll position and text no longer apply
+    it->scrollY = 0;
+    it->textHash.clear();
+}
+
+void TabLifecycle::recordScroll(const QString& key, double scrollY) {
+    auto it = m_tabs.find(key);
+    if (it != m_tabs.end()) it->scrollY = scrollY;
+}
+
+bool TabLifecycle::recordText(const QString& key, const QString& text) {
+    auto it = m_tabs.find(key);
+    if (it == m_tabs.end()) return true;
+    const QByteArray hash = QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1);
+    const bool changed = hash != it->textHash;
+    it->textHash = hash;
+    return changed;
+}
+
+QVariantMap TabLifecycle::snapshot(const QString& key) const {
+    const auto it = m_tabs.constFind(key);
+    if (it == m_tabs.cend()) return {};
+    return {
+        {"url", it->url},
+        {"scrollY", it->scrollY},
+        {"textHash", QString::fromLatin1(it->textHash.toHex())},
+        {"state", int(it->state)}
+    };
+}
+
+QVariantMap TabLifecycle::stats() const {
+    int active = 0, frozen = 0, discarded = 0;
+    for (const Tab& t : m_tabs) {
+        if (t.state == Active) ++active;
+        else if (t.state == Frozen) ++frozen;
+        else ++discarded;
+    }
+    return {
+        {"active", active},
+        {"frozen", frozen},
+        {"discarded", discarded},
+        {"estimatedMb", liveTabs() * m_tabEstimateMb},
+        {"budgetMb", m_budgetMb},
+        {"frozenTotal", m_frozenTotal},
+        {"discardedTotal", m_discardedTotal}
+    };
+}
+
+int TabLifecycle::liveTabs() const {
+    int live = 0;
+    for (const Tab& t : m_tabs) {
+        if (t.state != Discarded) ++live;
+    }
+    return live;
+}
+
+void TabLifecycle::transition(const QString& key, Tab& tab, State state) {
+    qDebug() << "TabLifecycle:" << key << tab.state << "->" << state;
+    tab.state = state;
+    if (state == Frozen) ++m_frozenTotal;
+    if (state == Discarded) ++m_discardedTotal;
+    emit stateRequested(key, state);
+}
+
+void TabLifecycle::evaluate() {
+    const qint64 now = m_clock.elapsed();
+    for (auto it = m_tabs.begin(); it != m_tabs.end(); ++it) {
+        if (it.key() == m_activeKey) continue;
+        const qint64 idle = now - it->lastActiveMs;
+        if (it->state == Active && m_freezeMs > 0 && idle >= m_freezeMs) {
+            transition(it.key(), *it, Frozen);
+        } else if (it->state == Frozen && m_discardMs > 0 && idle >= m_discardMs) {
+            transition(it.key(), *it, Discarded);
+        }
+    }
+
+    // Over budget: discard background tabs, least recently used first
+    if (m_budgetMb <= 0) return;
+    int live = liveTabs();
+    while (live * m_tabEstimateMb > m_budgetMb) {
+        auto lru = m_tabs.end();
+        for (auto it = m_tabs.begin(); it != m_tabs.end(); ++it) {
+            if (it.key() == m_activeKey || it->state == Discarded) continue;
+            if (lru == m_tabs.end() || it->lastActiveMs < lru->lastActiveMs) lru = it;
+        }
+        if (lru == m_tabs.end()) break;
+        qDebug() << "TabLifecycle: Over memory budget," << live << "live tabs";
+        transition(lru.key(), *lru, Discarded);
+        --live;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantMap>
+
+// Decides when background tabs give up their page: idle tabs are frozen, then
+// discarded, and the least recently used are discarded early once the live
+// tabs exceed the memory budget. QML applies the requested state to the tab's
+// WebEngineView (values match WebEngineView.LifecycleState). Each tab's URL,
+// scroll position and page text hash are kept so a discarded tab can be
+// restored where the user left it.
+class TabLifecycle : public QObject {
+    Q_OBJECT
+public:
+    enum State { Active = 0, Frozen = 1, Discarded = 2 };
+    Q_ENUM(State)
+
+    explicit TabLifecycle(QObject* parent=nullptr);
+
+    // A tab created as a placeholder has no page yet and starts out discarded
+    Q_INVOKABLE void registerTab(const QString& key, const QString& url, bool discarded);
+    Q_INVOKABLE void unregisterTab(const QString& key);
+    // The tab was brought to the front; requests Active if it wasn't
+    Q_INVOKABLE void activate(const QString& key);
+
+    Q_INVOKABLE void recordUrl(const QString& key, const QString& url);
+    Q_INVOKABLE void recordScroll(const QString& key, double scrollY);
+    // Returns true if the page text differs from the last recorded text
+    Q_INVOKABLE bool recordText(const QString& key, const QString& text);
+    // {url, scrollY, textHash, state} of a tab
+    Q_INVOKABLE QVariantMap snapshot(const QString& key) const;
+    Q_INVOKABLE QVariantMap stats() const;
+
+signals:
+    void stateRequested(const QString& key, int state);
+
+private:
+    struct Tab {
+        QString url;
+        State state{Active};
+        qint64 lastActiveMs{0};
+        double scrollY{0};
+        QByteArray textHash;
+    };
+
+    void evaluate();
+    void transition(const QString& key, Tab& tab, State state);
+    int liveTabs() const;
+
+    QHash<QString, Tab> m_tabs;
+    QString m_activeKey;
+    QElapsedTimer m_clock;
+    QTimer m_timer;
+    qint64 m_freezeMs;
+    qint64 m_discardMs;
+    int m_budgetMb;
+    int m_tabEstimateMb;
+    int m_frozenTotal{0};
+    int m_discardedTotal{0};
+};
@@ -0,0 +1,176 @@
+#include "themebackend.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+#include "config.h"
+
+namespace {
+// Breaker settings per backend; theme extraction is optional, so give up quickly
+constexpr int kBreakerThreshold = 2;
+constexpr qint64 kBreakerCooldownMs = 60000;
+}
+
+int AnthropicThemeBackend::timeoutMs() const {
+    return Config::getThemeRemoteTimeoutMs();
+}
+
+QNetworkRequest AnthropicThemeBackend::request() const {
+    QNetworkRequest req(QUrl("https://api.anthropic.com/v1/messages"));
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("x-api-key", m_apiKey->toUtf8());
+    req.setRawHeader("anthropic-version", "2023-06-01");
+    return req;
+}
+
+QByteArray AnthropicThemeBackend::body(const QString& system, const QString& prompt, int maxTokens) const {
+    QJsonArray messages;
+    messages.append(QJsonObject{
+        {"role", "user"},
+        {"content", prompt}
+    });
+    return QJsonDocument(QJsonObject{
+        {"model", model()},
+        {"system", system},
+        {"messages", messages},
+        {"max_tokens", maxTokens},
+        {"temperature", 0.3}
+    }).toJson(QJsonDocument::Compact);
+}
+
+QString AnthropicThemeBackend::replyText(const QJsonObject& response) const {
+    const QJsonArray content = response.value("content").toArray();
+    if (content.isEmpty() || !content.at(0).isObject()) return QString();
+    return content.at(0).toObject().value("text").toString();
+}
+
+UsageLedger::Usage AnthropicThemeBackend::usage(const QJsonObject& response) const {
+    return UsageLedger::fromJson(response.value("usage").toObject());
+}
+
+OpenAiThemeBackend::OpenAiThemeBackend(const QString& endpoint, const QString& model, const QString& apiKey)
+    : m_endpoint(endpoint), m_model(model), m_apiKey(apiKey) {
+    // Accept the server root as well as the full completions URL
+    if (!m_endpoint.isEmpty() && !m_endpoint.endsWith("/chat/completions")) {
+        while (m_endpoint.endsWith('/')) m_endpoint.chop(1);
+        if (!m_endpoint.endsWith("/v1")) m_endpoint += "/v1";
+        m_endpoint += "/chat/completions";
+    }
+}
+
+int OpenAiThemeBackend::timeoutMs() const {
+    return Config::getThemeLocalTimeoutMs();
+}
+
+QNetworkRequest OpenAiThemeBackend::request() const {
+    QNetworkRequest req{QUrl(m_endpoint)};
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    if (!m_apiKey.isEmpty()) req.setRawHeader("Authorization", "Bearer " + m_apiKey.toUtf8());
+    return req;
+}
+
+QByteArray OpenAiThemeBackend::body(const QString& system, const QString& prompt, int maxTokens) const {
+    QJsonArray messages;
+    messages.append(QJsonObject{{"role", "system"}, {"content", system}});
+    messages.append(QJsonObject{{"role", "user"}, {"content", prompt}});
+    return QJsonDocument(QJsonObject{
+        {"model", m_model},
+        {"messages", messages},
+        {"max_tokens", maxTokens},
+        {"temperature", 0.3},
+        {"stream", false}
+    }).toJson(QJsonDocument::Compact);
+}
+
+QString OpenAiThemeBackend::replyText(const QJsonObject& response) const {
+    const QJsonArray choices = response.value("choices").toArray();
+    if (choices.isEmpty()) return QString();
+    return choices.at(0).toObject().value("message").toObject().value("content").toString();
+}
+
+UsageLedger::Usage OpenAiThemeBackend::usage(const QJsonObject& response) const {
+    const QJsonObject u = response.value("usage").toObject();
+    UsageLedger::Usage out;
+    out.input = u.value("prompt_tokens").toInteger();
+    out.output = u.value("completion_tokens").toInteger();
+    return out;
+}
+
+ThemeBackends::ThemeBackends(const QString* anthropicApiKey)
+    : m_preferred(Config::getConfigValue("THEME_BACKEND", "auto").toLower()) {
+    Slot local;
+    local.backend = std::make_unique<OpenAiThemeBackend>(Config::getConfigValue("THEME_LOCAL_ENDPOINT", QString()),
+                                                         Config::getConfigValue("THEME_LOCAL_MODEL", "local"),
+                                                         Config::getConfigValue("THEME_LOCAL_API_KEY", QString()));
+    local.breaker = std::make_unique<CircuitBreaker>(kBreakerThreshold, kBreakerCooldownMs);
+    Slot remote;
+    remote.backend = std::make_unique<AnthropicThemeBackend>(anthropicApiKey);
+    remote.breaker = std::make_unique<CircuitBreaker>(kBreakerThreshold, kBreakerCooldownMs);
+    // Until both are measured the local server goes first; it is free and usually faster
+    m_slots.push_back(std::move(local));
+    m_slots.push_back(std::move(remote));
+}
+
+QVector<ThemeBackend*> ThemeBackends::order(bool unmeteredOnly) const {
+    struct Ranked {
+        ThemeBackend* backend;
+        int tier;     // 0 preferred by THEME_BACKEND, 1 healthy, 2 breaker open (last resort)
+        qint64 p50;   // -1 while unmeasured, so each backend gets its first sample
+    };
+    QVector<Ranked> ranked;
+    for (const Slot& s : m_slots) {
+        if (!s.backend->isConfigured()) continue;
+        if (unmeteredOnly && s.backend->isMetered()) continue;
+        int tier = 1;
+        if (s.breaker->state() == CircuitBreaker::State::Open) tier = 2;
+        else if (m_preferred == s.backend->name()) tier = 0;
+        ranked.append({s.backend.get(), tier, m_latency.percentile(s.backend->name(), 0.5)});
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+        return a.tier != b.tier ? a.tier < b.tier : a.p50 < b.p50;
+    });
+
+    QVector<ThemeBackend*> out;
+    for (const Ranked& r : ranked) out << r.backend;
+    return out;
+}
+
+bool ThemeBackends::allowRequest(ThemeBackend* backend) {
+    for (Slot& s : m_slots) {
+        if (s.backend.get() == backend) return s.breaker->allowRequest();
+    }
+    return false;
+}
+
+void ThemeBackends::recordSuccess(ThemeBackend* backend, qint64 ms, int documents) {
+    // Batched requests take longer; compare backends per document
+    m_latency.record(backend->name(), ms / qMax(1, documents));
+    for (Slot& s : m_slots) {
+        if (s.backend.get() == backend) s.breaker->recordSuccess();
+    }
+}
+
+void ThemeBackends::recordFailure(ThemeBackend* backend) {
+    for (Slot& s : m_slots) {
+        if (s.backend.get() != backend) continue;
+        s.breaker->recordFailure();
+        ++s.failures;
+    }
+}
+
+QVariantMap ThemeBackends::stats() const {
+    QVariantMap out;
+    for (const Slot& s : m_slots) {
+        const QString name = s.backend->name();
+        out.insert(name, QVariantMap{
+            {"configured", s.backend->isConfigured()},
+            {"model", s.backend->model()},
+            {"samples", m_latency.sampleCount(name)},
+            {"p50Ms", m_latency.percentile(name, 0.5)},
+            {"failures", s.failures},
+            {"breakerOpen", s.breaker->state() == CircuitBreaker::State::Open}
+        });
+    }
+    return out;
+}
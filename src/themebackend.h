@@ -0,0 +1,98 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QNetworkRequest>
+#include <QVariantMap>
+#include <QVector>
+#include <memory>
+#include <vector>
+#include "mcpresilience.h"
+#include "usageledger.h"
+
+// A model server theme extraction can be sent to. Backends only build the
+// request and read the reply; Analyzer owns the network, batching and the
+// naive fallback.
+class ThemeBackend {
+public:
+    virtual ~ThemeBackend() = default;
+
+    virtual QString name() const = 0;
+    virtual QString model() const = 0;
+    virtual bool isConfigured() const = 0;
+    // Whether calls cost tokens that count toward the usage ledger and budgets
+    virtual bool isMetered() const = 0;
+    virtual int timeoutMs() const = 0;
+
+    virtual QNetworkRequest request() const = 0;
+    virtual QByteArray body(const QString& system, const QString& prompt, int maxTokens) const = 0;
+    // Empty when the response holds no text
+    virtual QString replyText(const QJsonObject& response) const = 0;
+    virtual UsageLedger::Usage usage(const QJsonObject& response) const = 0;
+};
+
+// Claude Messages API
+class AnthropicThemeBackend : public ThemeBackend {
+public:
+    explicit AnthropicThemeBackend(const QString* apiKey) : m_apiKey(apiKey) {}
+
+    QString name() const override { return QStringLiteral("anthropic"); }
+    QString model() const override { return QStringLiteral("claude-3-5-haiku-20241022"); }
+    bool isConfigured() const override { return !m_apiKey->isEmpty(); }
+    bool isMetered() const override { return true; }
+    int timeoutMs() const override;
+    QNetworkRequest request() const override;
+    QByteArray body(const QString& system, const QString& prompt, int maxTokens) const override;
+    QString replyText(const QJsonObject& response) const override;
+    UsageLedger::Usage usage(const QJsonObject& response) const override;
+
+private:
+    const QString* m_apiKey; // Analyzer's key, which may be set after construction
+};
+
+// OpenAI-compatible /v1/chat/completions, e.g. a llama.cpp server on localhost
+class OpenAiThemeBackend : public ThemeBackend {
+public:
+    OpenAiThemeBackend(const QString& endpoint, const QString& model, const QString& apiKey);
+
+    QString name() const override { return QStringLiteral("local"); }
+    QString model() const override { return m_model; }
+    bool isConfigured() const override { return !m_endpoint.isEmpty(); }
+    bool isMetered() const override { return false; }
+    int timeoutMs() const override;
+    QNetworkRequest request() const override;
+    QByteArray body(const QString& system, const QString& prompt, int maxTokens) const override;
+    QString replyText(const QJsonObject& response) const override;
+    UsageLedger::Usage usage(const QJsonObject& response) const override;
+
+private:
+    QString m_endpoint;
+    QString m_model;
+    QString m_apiKey;
+};
+
+// Orders the configured backends for each request: any not yet measured
+// first, then by median latency per document. Failures trip a per-backend
+// circuit breaker so a dead local server is skipped until its cooldown ends.
+class ThemeBackends {
+public:
+    explicit ThemeBackends(const QString* anthropicApiKey);
+
+    // Backends to try, best first; unmeteredOnly when the token budget is spent
+    QVector<ThemeBackend*> order(bool unmeteredOnly = false) const;
+    bool allowRequest(ThemeBackend* backend);
+    void recordSuccess(ThemeBackend* backend, qint64 ms, int documents);
+    void recordFailure(ThemeBackend* backend);
+    QVariantMap stats() const;
+
+private:
+    struct Slot {
+        std::unique_ptr<ThemeBackend> backend;
+        std::unique_ptr<CircuitBreaker> breaker;
+        int failures{0};
+    };
+
+    QString m_preferred; // THEME_BACKEND; "auto" lets latency decide
+    std::vector<Slot> m_slots;
+    LatencyTracker m_latency;
+};
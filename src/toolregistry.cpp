@@ -0,0 +1,197 @@
+#include "toolregistry.h"
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QDebug>
+
+namespace {
+// Descriptions tuned for the ReAct prompt; they win over the server's wording
+const QHash<QString, QString>& descriptionOverrides() {
+    static const QHash<QString, QString> overrides{
+        {"search-statistics", "Search Statista database for statistics on a topic. Returns up to 10 results with titles, summaries, and IDs. Use ONCE per query unless first search completely failed. Evaluate results before searching again."},
+        {"get-chart-data-by-id", "Get detailed data points and methodology for a specific Statista chart. Use ONLY when search results lack specific numbers you need. Maximum 2 chart fetches per query. Only fetch if the summary doesn't have enough detail."}
+    };
+    return overrides;
+}
+
+const QHash<QString, QString>& progressMessages() {
+    static const QHash<QString, QString> messages{
+        {"search-statistics", "\n\n🔍 Searching Statista...\n"},
+        {"statista.llm.chat.stream", "\n\n🔍 Searching Statista database for relevant statistics and data...\n"},
+        {"statista.llm.search", "\n\n🔍 Searching for relevant information...\n"},
+        {"statista.insights.generate", "\n\n📊 Generating insights from the data...\n"},
+        {"statista.chart.generate", "\n\n📈 Creating chart visualization...\n"}
+    };
+    return messages;
+}
+
+// Tools we know to be read-only even if the server omits annotations
+bool knownReadOnly(const QString& name) {
+    return name == "search-statistics" || name == "get-chart-data-by-id";
+}
+}
+
+ToolRegistry::ToolRegistry(QObject* parent) : QObject(parent) {
+    rebuild(builtinTools());
+}
+
+QVector<ToolRegistry::Tool> ToolRegistry::builtinTools() {
+    Tool search;
+    search.name = "search-statistics";
+    search.inputSchema = QJsonObject{
+        {"type", "object"},
+        {"properties", QJsonObject{
+            {"query", QJsonObject{
+                {"type", "string"},
+                {"description", "The search query for statistics"}
+            }},
+            {"limit", QJsonObject{
+                {"type", "integer"},
+                {"description", "Maximum number of results (default 10)"},
+                {"default", 10}
+            }}
+        }},
+        {"required", QJsonArray{"query"}}
+    };
+
+    Tool chart;
+    chart.name = "get-chart-data-by-id";
+    chart.inputSchema = QJsonObject{
+        {"type", "object"},
+        {"properties", QJsonObject{
+            {"id", QJsonObject{
+                {"type", "string"},
+                {"description", "The Statista chart/statistic ID"}
+            }}
+        }},
+        {"required", QJsonArray{"id"}}
+    };
+    return {search, chart};
+}
+
+void ToolRegistry::rebuild(const QVector<Tool>& tools) {
+    // Interning is append-only: a stream in flight keeps the id it looked up,
+    // so a name keeps its id across refreshes, and a tool the server dropped
+    // keeps its entry but is no longer offered to Claude
+    m_toolsArray = QJsonArray();
+    QSet<QString> offered;
+
+    for (Tool t : tools) {
+        if (t.name.isEmpty() || offered.contains(t.name)) continue;
+        offered.insert(t.name);
+        const int existing = m_ids.value(t.name, -1);
+        t.id = existing >= 0 ? existing : m_tools.size();
+        t.description = descriptionOverrides().value(t.name, t.description);
+        t.progressMessage = progressMessages().value(t.name, QString("\n\n🔧 Using %1...\n").arg(t.name));
+        t.readOnly = t.readOnly || knownReadOnly(t.name);
+        m_toolsArray.append(QJsonObject{
+            {"name", t.name},
+            {"description", t.description},
+            {"input_schema", t.inputSchema}
+        });
+        if (existing >= 0) {
+            m_tools[existing] = t;
+        } else {
+            m_ids.insert(t.name, t.id);
+            m_tools.append(t);
+        }
+    }
+    m_toolsJson = QJsonDocument(m_toolsArray).toJson(QJsonDocument::Compact);
+}
+
+bool ToolRegistry::updateFromList(const QJsonArray& tools, const QByteArray& etag) {
+    if (!applyList(tools, etag)) return false;
+    saveCache();
+    emit toolsChanged();
+    return true;
+}
+
+bool ToolRegistry::applyList(const QJsonArray& tools, const QByteArray& etag) {
+    const QByteArray raw = QJsonDocument(tools).toJson(QJsonDocument::Compact);
+    const QByteArray version = QCryptographicHash::hash(raw, QCryptographicHash::Sha1).toHex();
+    if (!etag.isEmpty()) m_etag = etag;
+    if (version == m_version || tools.isEmpty()) return false;
+
+    QVector<Tool> parsed;
+    for (const auto& v : tools) {
+        const QJsonObject o = v.toObject();
+        Tool t;
+        t.name = o.value("name").toString();
+        t.description = o.value("description").toString();
+        t.inputSchema = o.value("inputSchema").toObject();
+        if (t.inputSchema.isEmpty()) t.inputSchema = QJsonObject{{"type", "object"}};
+        t.readOnly = o.value("annotations").toObject().value("readOnlyHint").toBool();
+        parsed.append(t);
+    }
+
+    rebuild(parsed);
+    m_version = version;
+    qDebug() << "ToolRegistry: Loaded" << m_toolsArray.size() << "tools, version" << m_version.left(8);
+
+    m_rawTools = tools;
+    return true;
+}
+
+bool ToolRegistry::loadCache(const QString& path) {
+    m_cachePath = path;
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly)) return false;
+    const QJsonObject cache = QJsonDocument::fromJson(f.readAll()).object();
+    const QJsonArray tools = cache.value("tools").toArray();
+    if (tools.isEmpty()) return false;
+    // Already on disk as it is, so no saveCache()
+    if (!applyList(tools, cache.value("etag").toString().toLatin1())) return false;
+    emit toolsChanged();
+    return true;
+}
+
+bool ToolRegistry::saveCache() const {
+    if (m_cachePath.isEmpty() || m_rawTools.isEmpty()) return false;
+    // Keep the raw list so the cache round-trips through the same parser
+    QDir().mkpath(QFileInfo(m_cachePath).absolutePath());
+    QSaveFile f(m_cachePath);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "ToolRegistry: Cannot write cache" << m_cachePath;
+        return false;
+    }
+    f.write(QJsonDocument(QJsonObject{
+        {"version", QString::fromLatin1(m_version)},
+        {"etag", QString::fromLatin1(m_etag)},
+        {"tools", m_rawTools}
+    }).toJson(QJsonDocument::Compact));
+    return f.commit();
+}
+
+QString ToolRegistry::progressMessage(int id, const QString& fallbackName) const {
+    if (const Tool* t = tool(id)) return t->progressMessage;
+    return progressMessages().value(fallbackName, QString("\n\n🔧 Using %1...\n").arg(fallbackName));
+}
+
+bool ToolRegistry::isReadOnly(const QString& name) const {
+    const Tool* t = tool(idOf(name));
+    return t ? t->readOnly : knownReadOnly(name);
+}
+
+QStringList ToolRegistry::requiredArgs(int id) const {
+    QStringList keys;
+    if (const Tool* t = tool(id)) {
+        for (const auto& v : t->inputSchema.value("required").toArray()) keys << v.toString();
+    }
+    return keys;
+}
+
+QJsonObject ToolRegistry::argDefaults(int id) const {
+    QJsonObject defaults;
+    if (const Tool* t = tool(id)) {
+        const QJsonObject props = t->inputSchema.value("properties").toObject();
+        for (auto it = props.begin(); it != props.end(); ++it) {
+            const QJsonValue def = it.value().toObject().value("default");
+            if (!def.isUndefined()) defaults.insert(it.key(), def);
+        }
+    }
+    return defaults;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QByteArray>
+#include <QStringList>
+
+// Registry of the MCP tools offered to Claude. Starts from the built-in Statista
+// tools, is refreshed from the server's tools/list and cached on disk. Tools are
+// interned to small integer ids, and the Claude "tools" array is kept
+// pre-serialized so requests never rebuild it.
+class ToolRegistry : public QObject {
+    Q_OBJECT
+public:
+    struct Tool {
+        int id{-1};
+        QString name;
+        QString description;
+        QJsonObject inputSchema;
+        QString progressMessage; // shown in the chat while the tool runs
+        bool readOnly{false};    // safe to retry / hedge
+    };
+
+    explicit ToolRegistry(QObject* parent=nullptr);
+
+    bool loadCache(const QString& path);
+    bool saveCache() const;
+
+    // Replace the tool set from a tools/list result; returns false when unchanged
+    bool updateFromList(const QJsonArray& tools, const QByteArray& etag = QByteArray());
+
+    int idOf(const QString& name) const { return m_ids.value(name, -1); }
+    const Tool* tool(int id) const { return (id >= 0 && id < m_tools.size()) ? &m_tools.at(id) : nullptr; }
+    QString progressMessage(int id, const QString& fallbackName) const;
+    bool isReadOnly(const QString& name) const;
+    QStringList requiredArgs(int id) const;
+    // Schema defaults of the optional arguments, by argument name
+    QJsonObject argDefaults(int id) const;
+
+    QByteArray version() const { return m_version; }
+    QByteArray etag() const { return m_etag; }
+    const QJsonArray& toolsArray() const { return m_toolsArray; }
+    const QByteArray& toolsJson() const { return m_toolsJson; }
+
+signals:
+    void toolsChanged();
+
+private:
+    // updateFromList() without saving or notifying
+    bool applyList(const QJsonArray& tools, const QByteArray& etag);
+    void rebuild(const QVector<Tool>& tools);
+    static QVector<Tool> builtinTools();
+
+    QString m_cachePath;
+    QVector<Tool> m_tools;       // index == interned id; grows only, ids stay stable
+    QHash<QString, int> m_ids;
+    QJsonArray m_rawTools;       // tools/list result as received
+    QJsonArray m_toolsArray;     // Claude tools array
+    QByteArray m_toolsJson;      // same, compact-serialized once
+    QByteArray m_version;        // content hash of the server's tool list
+    QByteArray m_etag;
+};
@@ -0,0 +1,155 @@
+#include "toolresultreducer.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSet>
+#include <QDebug>
+#include <cmath>
+#include "config.h"
+
+namespace {
+// Presentation-only fields Statista attaches to items
+const QSet<QString>& droppedKeys() {
+    static const QSet<QString> keys{"image", "images", "thumbnail", "teaser_image_urls", "icon",
+                                    "premium", "isPremium", "html", "svg", "style"};
+    return keys;
+}
+
+QString capString(const QString& s, int maxChars) {
+    if (maxChars <= 0 || s.size() <= maxChars) return s;
+    return s.left(maxChars).trimmed() + "…";
+}
+
+// Four significant digits is plenty for the model to quote a statistic
+double roundSignificant(double v) {
+    if (v == 0 || std::floor(v) == v) return v;
+    const double scale = std::pow(10.0, 3 - std::floor(std::log10(std::fabs(v))));
+    return std::round(v * scale) / scale;
+}
+}
+
+ToolResultReducer::ToolResultReducer() : m_enabled(Config::getToolResultReduce()) {
+    // Search hits: the model picks by title/summary and fetches details by id
+    Profile search;
+    search.itemFields = {"id", "title", "subject", "description", "summary", "date", "source"};
+    search.maxItems = Config::getToolResultMaxItems();
+    search.maxStringChars = Config::getToolResultMaxString();
+    m_profiles.insert("search-statistics", search);
+
+    // Chart data: keep all fields, the series is what the model quotes
+    Profile chart;
+    chart.maxItems = 20;
+    chart.maxStringChars = 500;
+    m_profiles.insert("get-chart-data-by-id", chart);
+}
+
+ToolResultReducer::Reduction ToolResultReducer::reduce(const QString& toolName, const QString& text) {
+    QJsonParseError err;
+    const QJsonDocument doc = m_enabled ? QJsonDocument::fromJson(text.toUtf8(), &err) : QJsonDocument();
+    return reduce(toolName, text, doc);
+}
+
+ToolResultReducer::Reduction ToolResultReducer::reduce(const QString& toolName, const QString& text, const QJsonDocument& parsed) {
+    Reduction r;
+    r.bytesIn = text.toUtf8().size();
+    r.text = text;
+
+    if (m_enabled) {
+        const Profile p = profile(toolName);
+        if (parsed.isObject() || parsed.isArray()) {
+            const QJsonValue reduced = reduceValue(parsed.isObject() ? QJsonValue(parsed.object()) : QJsonValue(parsed.array()), p, false);
+            const QJsonDocument out = reduced.isObject() ? QJsonDocument(reduced.toObject()) : QJsonDocument(reduced.toArray());
+            r.text = QString::fromUtf8(out.toJson(QJsonDocument::Compact));
+        } else {
+            r.text = capString(text, p.maxTextChars);
+        }
+    }
+    r.bytesOut = r.text.toUtf8().size();
+
+    ++m_calls;
+    m_bytesIn += r.bytesIn;
+    m_bytesOut += r.bytesOut;
+    qDebug() << "ToolResultReducer:" << toolName << r.bytesIn << "->" << r.bytesOut
+             << "bytes, ~" << r.tokensSaved() << "tokens saved";
+    return r;
+}
+
+QJsonValue ToolResultReducer::reduceValue(const QJsonValue& value, const Profile& p, bool listItem) const {
+    switch (value.type()) {
+    case QJsonValue::String:
+        return capString(value.toString(), p.maxStringChars);
+    case QJsonValue::Double:
+        return roundSignificant(value.toDouble());
+    case QJsonValue::Object: {
+        const QJsonObject in = value.toObject();
+        QJsonObject out;
+        for (auto it = in.begin(); it != in.end(); ++it) {
+            if (droppedKeys().contains(it.key())) continue;
+            if (listItem && !p.itemFields.isEmpty() && !p.itemFields.contains(it.key())) continue;
+            const QJsonValue v = reduceValue(it.value(), p, false);
+            if (v.isNull() || (v.isString() && v.toString().isEmpty())) continue;
+            out.insert(it.key(), v);
+        }
+        return out;
+    }
+    case QJsonValue::Array: {
+        const QJsonArray in = value.toArray();
+        QJsonValue series;
+        if (compactSeries(in, p, &series)) return series;
+        QJsonArray out;
+        const int keep = p.maxItems > 0 ? qMin(int(in.size()), p.maxItems) : int(in.size());
+        for (int i = 0; i < keep; ++i) out.append(reduceValue(in.at(i), p, in.at(i).isObject()));
+        if (keep < in.size()) out.append(QString("… %1 more omitted").arg(in.size() - keep));
+        return out;
+    }
+    default:
+        return value;
+    }
+}
+
+bool ToolResultReducer::compactSeries(const QJsonArray& array, const Profile& p, QJsonValue* out) {
+    // A series: several objects with the same few scalar keys, at least one numeric
+    if (array.size() < 4 || !array.first().isObject()) return false;
+    const QStringList columns = array.first().toObject().keys();
+    if (columns.isEmpty() || columns.size() > 4) return false;
+    bool numeric = false;
+    for (const auto& v : array) {
+        if (!v.isObject()) return false;
+        const QJsonObject o = v.toObject();
+        if (o.keys() != columns) return false;
+        for (const auto& c : columns) {
+            const QJsonValue cell = o.value(c);
+            if (cell.isObject() || cell.isArray()) return false;
+            numeric = numeric || cell.isDouble();
+        }
+    }
+    if (!numeric) return false;
+
+    // Evenly downsample long series, always keeping the first and last points
+    const int n = array.size();
+    const int points = p.maxSeriesPoints > 1 ? qMin(n, p.maxSeriesPoints) : n;
+    QJsonArray rows;
+    for (int i = 0; i < points; ++i) {
+        const int src = points == n ? i : int(std::lround(double(i) * (n - 1) / (points - 1)));
+        const QJsonObject o = array.at(src).toObject();
+        QJsonArray row;
+        for (const auto& c : columns) {
+            const QJsonValue cell = o.value(c);
+            row.append(cell.isDouble() ? QJsonValue(roundSignificant(cell.toDouble())) : cell);
+        }
+        rows.append(row);
+    }
+    QJsonObject table{{"columns", QJsonArray::fromStringList(columns)}, {"rows", rows}};
+    if (points < n) table.insert("note", QString("downsampled from %1 points").arg(n));
+    *out = table;
+    return true;
+}
+
+QVariantMap ToolResultReducer::stats() const {
+    return {
+        {"calls", m_calls},
+        {"bytesIn", m_bytesIn},
+        {"bytesOut", m_bytesOut},
+        {"tokensSaved", (m_bytesIn - m_bytesOut) / 4}
+    };
+}
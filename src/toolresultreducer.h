@@ -0,0 +1,51 @@
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QJsonValue>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QVariantMap>
+
+// Shrinks MCP tool output before it is sent back to Claude: projects item
+// fields the model uses, caps item counts and string lengths, and turns
+// uniform arrays of data points into a compact columns/rows table.
+class ToolResultReducer {
+public:
+    struct Profile {
+        QStringList itemFields;   // keep only these keys on list items (empty = all)
+        int maxItems{10};
+        int maxStringChars{400};
+        int maxSeriesPoints{24};
+        int maxTextChars{8000};   // cap for non-JSON output
+    };
+    struct Reduction {
+        QString text;
+        int bytesIn{0};
+        int bytesOut{0};
+        int tokensSaved() const { return (bytesIn - bytesOut) / 4; }
+    };
+
+    ToolResultReducer();
+
+    void setProfile(const QString& toolName, const Profile& profile) { m_profiles.insert(toolName, profile); }
+    Profile profile(const QString& toolName) const { return m_profiles.value(toolName, m_default); }
+
+    Reduction reduce(const QString& toolName, const QString& text);
+    // Same, for text the caller already parsed; skips the second parse
+    Reduction reduce(const QString& toolName, const QString& text, const QJsonDocument& parsed);
+    QVariantMap stats() const;
+
+private:
+    QJsonValue reduceValue(const QJsonValue& value, const Profile& p, bool listItem) const;
+    static bool compactSeries(const QJsonArray& array, const Profile& p, QJsonValue* out);
+
+    bool m_enabled;
+    Profile m_default;
+    QHash<QString, Profile> m_profiles;
+
+    // Running totals for stats()
+    int m_calls{0};
+    qint64 m_bytesIn{0};
+    qint64 m_bytesOut{0};
+};
@@ -0,0 +1,46 @@
+#include "turnbudget.h"
+#include "config.h"
+
+TurnBudget::TurnBudget()
+    : m_maxToolCalls(Config::getTurnMaxToolCalls()),
+      m_maxRoundTrips(Config::getTurnMaxRoundTrips()),
+      m_maxTurnMs(qint64(Config::getTurnMaxSeconds()) * 1000) {
+    // Mirrors the limits stated in the system prompts
+    m_perToolLimits.insert("search-statistics", Config::getTurnMaxSearches());
+    m_perToolLimits.insert("get-chart-data-by-id", Config::getTurnMaxChartFetches());
+}
+
+void TurnBudget::start() {
+    m_timer.start();
+    m_toolCalls = 0;
+    m_roundTrips = 1; // the request that opens the turn
+    m_perToolCalls.clear();
+}
+
+bool TurnBudget::timeExhausted() const {
+    return m_maxTurnMs > 0 && m_timer.isValid() && m_timer.elapsed() >= m_maxTurnMs;
+}
+
+bool TurnBudget::allowsToolCall(const QString& toolName) const {
+    return exhaustedReason(toolName).isEmpty();
+}
+
+void TurnBudget::recordToolCall(const QString& toolName) {
+    ++m_toolCalls;
+    ++m_perToolCalls[toolName];
+}
+
+bool TurnBudget::mustAnswer() const {
+    return m_roundTrips >= m_maxRoundTrips || m_toolCalls >= m_maxToolCalls || timeExhausted();
+}
+
+QString TurnBudget::exhaustedReason(const QString& toolName) const {
+    if (timeExhausted()) return QString("time limit of %1 s reached").arg(m_maxTurnMs / 1000);
+    if (m_toolCalls >= m_maxToolCalls) return QString("limit of %1 tool calls reached").arg(m_maxToolCalls);
+    if (m_roundTrips >= m_maxRoundTrips) return QString("limit of %1 round-trips reached").arg(m_maxRoundTrips);
+    if (!toolName.isEmpty() && m_perToolLimits.contains(toolName) &&
+        m_perToolCalls.value(toolName) >= m_perToolLimits.value(toolName)) {
+        return QString("limit of %1 %2 calls reached").arg(m_perToolLimits.value(toolName)).arg(toolName);
+    }
+    return QString();
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+
+// Per-turn limits on the ReAct tool loop. The system prompts ask Claude for at
+// most two searches and two chart fetches; this enforces that on the client,
+// together with caps on total tool calls, Claude round-trips and wall-clock time.
+class TurnBudget {
+public:
+    TurnBudget();
+
+    void start();
+    bool allowsToolCall(const QString& toolName) const;
+    void recordToolCall(const QString& toolName);
+    void recordRoundTrip() { ++m_roundTrips; }
+    // True when the next request to Claude must be the final answer
+    bool mustAnswer() const;
+    QString exhaustedReason(const QString& toolName = QString()) const;
+
+    int toolCalls() const { return m_toolCalls; }
+    int roundTrips() const { return m_roundTrips; }
+    qint64 elapsedMs() const { return m_timer.isValid() ? m_timer.elapsed() : 0; }
+
+private:
+    bool timeExhausted() const;
+
+    int m_maxToolCalls;
+    int m_maxRoundTrips;
+    qint64 m_maxTurnMs;
+    QHash<QString, int> m_perToolLimits;
+
+    QElapsedTimer m_timer;
+    int m_toolCalls{0};
+    int m_roundTrips{0};
+    QHash<QString, int> m_perToolCalls;
+};
@@ -0,0 +1,149 @@
+#include "usageledger.h"
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QUrl>
+#include <QDebug>
+#include "config.h"
+
+namespace {
+struct Price {
+    const char* family;
+    double inputPerMTok;
+    double outputPerMTok;
+};
+
+// List prices in USD per million tokens; cache writes cost 1.25x input, reads 0.1x
+const Price kPrices[] = {
+    {"haiku", 0.80, 4.0},
+    {"sonnet", 3.0, 15.0},
+    {"opus", 15.0, 75.0},
+};
+}
+
+UsageLedger::Usage& UsageLedger::Usage::operator+=(const Usage& o) {
+    input += o.input;
+    output += o.output;
+    cacheRead += o.cacheRead;
+    cacheWrite += o.cacheWrite;
+    requests += o.requests;
+    costUsd += o.costUsd;
+    return *this;
+}
+
+QVariantMap UsageLedger::Usage::toMap() const {
+    return {
+        {"input", input},
+        {"output", output},
+        {"cacheRead", cacheRead},
+        {"cacheWrite", cacheWrite},
+        {"tokens", tokens()},
+        {"requests", requests},
+        {"costUsd", costUsd}
+    };
+}
+
+UsageLedger::UsageLedger(QObject* parent) : QObject(parent),
+    m_sessionBudget(Config::getUsageSessionTokenBudget()),
+    m_backgroundBudget(Config::getUsageBackgroundTokenBudget()) {}
+
+UsageLedger::Usage UsageLedger::fromJson(const QJsonObject& usage) {
+    Usage u;
+    u.input = usage.value("input_tokens").toInteger();
+    u.output = usage.value("output_tokens").toInteger();
+    u.cacheRead = usage.value("cache_read_input_tokens").toInteger();
+    u.cacheWrite = usage.value("cache_creation_input_tokens").toInteger();
+    return u;
+}
+
+double UsageLedger::costOf(const QString& model, const Usage& u) {
+    for (const Price& p : kPrices) {
+        if (!model.contains(QLatin1String(p.family))) continue;
+        return (u.input * p.inputPerMTok
+                + u.cacheWrite * p.inputPerMTok * 1.25
+                + u.cacheRead * p.inputPerMTok * 0.1
+                + u.output * p.outputPerMTok) / 1e6;
+    }
+    return 0;
+}
+
+QString UsageLedger::originName(Origin origin) {
+    switch (origin) {
+    case Origin::ChatTurn: return "chat_turn";
+    case Origin::ToolRoundTrip: return "tool_round_trip";
+    case Origin::ThemeExtraction: return "theme_extraction";
+    case Origin::Background: return "background";
+    }
+    return "unknown";
+}
+
+UsageLedger::Usage UsageLedger::record(Origin origin, const QString& conversation, const QString& model, Usage u) {
+    if (u.requests == 0) u.requests = 1;
+    u.costUsd = costOf(model, u);
+    m_total += u;
+    m_byOrigin[int(origin)] += u;
+    if (!conversation.isEmpty()) m_byConversation[conversation] += u;
+    qDebug() << "UsageLedger:" << originName(origin) << model << "in" << u.input << "out" << u.output
+             << "cache r/w" << u.cacheRead << "/" << u.cacheWrite << "session total" << m_total.tokens();
+
+    if (m_sessionBudget > 0 && !m_sessionExceeded && m_total.tokens() > m_sessionBudget) {
+        m_sessionExceeded = true;
+        qDebug() << "UsageLedger: Session token budget exceeded, background work disabled";
+        emit budgetExceeded("session");
+    }
+    const qint64 background = m_byOrigin.value(int(Origin::ThemeExtraction)).tokens()
+                              + m_byOrigin.value(int(Origin::Background)).tokens();
+    if (m_backgroundBudget > 0 && !m_backgroundExceeded && background > m_backgroundBudget) {
+        m_backgroundExceeded = true;
+        qDebug() << "UsageLedger: Background token budget exceeded, background work disabled";
+        emit budgetExceeded("background");
+    }
+    emit changed();
+    return u;
+}
+
+bool UsageLedger::allowsBackgroundWork() const {
+    return !m_sessionExceeded && !m_backgroundExceeded;
+}
+
+QVariantMap UsageLedger::byOrigin() const {
+    QVariantMap out;
+    for (auto it = m_byOrigin.cbegin(); it != m_byOrigin.cend(); ++it) {
+        out.insert(originName(Origin(it.key())), it->toMap());
+    }
+    return out;
+}
+
+QVariantMap UsageLedger::byConversation() const {
+    QVariantMap out;
+    for (auto it = m_byConversation.cbegin(); it != m_byConversation.cend(); ++it) {
+        out.insert(it.key(), it->toMap());
+    }
+    return out;
+}
+
+QString UsageLedger::exportJson() const {
+    const QJsonObject report{
+        {"exportedAt", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"totals", QJsonObject::fromVariantMap(totals())},
+        {"byOrigin", QJsonObject::fromVariantMap(byOrigin())},
+        {"byConversation", QJsonObject::fromVariantMap(byConversation())},
+        {"budgets", QJsonObject{
+            {"sessionTokens", m_sessionBudget},
+            {"backgroundTokens", m_backgroundBudget},
+            {"backgroundAllowed", allowsBackgroundWork()}
+        }}
+    };
+    return QString::fromUtf8(QJsonDocument(report).toJson(QJsonDocument::Indented));
+}
+
+bool UsageLedger::exportToFile(const QString& path) const {
+    const QUrl url(path);
+    QSaveFile f(url.isLocalFile() ? url.toLocalFile() : path);
+    if (!f.open(QIODevice::WriteOnly)) {
+        qDebug() << "UsageLedger: Cannot write" << path;
+        return false;
+    }
+    f.write(exportJson().toUtf8());
+    return f.commit();
+}
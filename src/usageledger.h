@@ -0,0 +1,63 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QVariantMap>
+#include <QJsonObject>
+
+// Session-wide token accounting. Every Claude response reports its usage here,
+// tagged with what caused it (a chat turn, a tool round-trip, theme extraction
+// or background work), so the cost of each feature is visible in QML and can
+// be exported as JSON. Optional soft budgets stop background work once exceeded.
+class UsageLedger : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap totals READ totals NOTIFY changed)
+    Q_PROPERTY(bool backgroundAllowed READ allowsBackgroundWork NOTIFY changed)
+public:
+    enum class Origin { ChatTurn, ToolRoundTrip, ThemeExtraction, Background };
+
+    struct Usage {
+        qint64 input{0};
+        qint64 output{0};
+        qint64 cacheRead{0};   // prompt tokens served from the prompt cache
+        qint64 cacheWrite{0};  // prompt tokens written to the prompt cache
+        int requests{0};
+        double costUsd{0};
+
+        Usage& operator+=(const Usage& o);
+        qint64 tokens() const { return input + output + cacheRead + cacheWrite; }
+        QVariantMap toMap() const;
+    };
+
+    explicit UsageLedger(QObject* parent=nullptr);
+
+    // Usage object of a Messages API response or stream event; missing fields stay 0
+    static Usage fromJson(const QJsonObject& usage);
+    static double costOf(const QString& model, const Usage& u);
+    static QString originName(Origin origin);
+
+    // Adds one response's usage; returns it with requests and cost filled in
+    Usage record(Origin origin, const QString& conversation, const QString& model, Usage u);
+
+    QVariantMap totals() const { return m_total.toMap(); }
+    Q_INVOKABLE QVariantMap byOrigin() const;
+    Q_INVOKABLE QVariantMap byConversation() const;
+    Q_INVOKABLE QString exportJson() const;
+    // Accepts a local path or a file:// URL (as produced by QML file dialogs)
+    Q_INVOKABLE bool exportToFile(const QString& path) const;
+
+    // False once a soft budget is exceeded; optional work should then be skipped
+    bool allowsBackgroundWork() const;
+
+signals:
+    void changed();
+    void budgetExceeded(const QString& which);
+
+private:
+    Usage m_total;
+    QHash<int, Usage> m_byOrigin;
+    QHash<QString, Usage> m_byConversation;
+    qint64 m_sessionBudget;
+    qint64 m_backgroundBudget;
+    bool m_sessionExceeded{false};
+    bool m_backgroundExceeded{false};
+};
@@ -0,0 +1,220 @@
+// AnswerCache: question normalization, what goes into the key, TTL pruning on
+// load and eviction past the cap.
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDateTime>
+#include "answercache.h"
+
+namespace {
+constexpr qint64 kHourMs = 3600 * 1000;
+
+AnswerCache::Entry entry(const QString& text, qint64 storedAt) {
+    AnswerCache::Entry e;
+    e.text = text;
+    e.model = QStringLiteral("claude-test");
+    e.storedAt = storedAt;
+    return e;
+}
+
+QVariantMap pageContext(const QString& url, const QString& pageText = QString()) {
+    QVariantMap context;
+    context["page"] = QVariantMap{{"url", url}};
+    if (!pageText.isEmpty()) context["pageText"] = pageText;
+    return context;
+}
+}
+
+class TestAnswerCache : public QObject {
+    Q_OBJECT
+
+private slots:
+    void normalizesQuestion_data();
+    void normalizesQuestion();
+    void keyIgnoresWording();
+    void keySeparatesContext();
+    void keyHashesPageTextWithoutUrl();
+    void keySeparatesThreads();
+    void storesAndLooksUp();
+    void skipsEmptyAnswersAndDisabledCache();
+    void evictsOldestPastCap();
+    void roundTripsThroughFile();
+    void prunesExpiredOnLoad();
+    void ignoresIncompatibleFile();
+};
+
+void TestAnswerCache::normalizesQuestion_data() {
+    QTest::addColumn<QString>("question");
+    QTest::addColumn<QString>("normalized");
+
+    QTest::newRow("case, punctuation, spacing") << "  What's the GDP   of France?? " << "what s the gdp of france";
+    QTest::newRow("line breaks") << "\tHello,\nworld!" << "hello world";
+    QTest::newRow("theme template") << "Tell me about statistics related to EVs" << "theme evs";
+    QTest::newRow("search template") << "Search for statistics about EVs." << "theme evs";
+    QTest::newRow("template mid-sentence") << "Please tell me about statistics related to EVs"
+                                           << "please tell me about statistics related to evs";
+    QTest::newRow("empty") << "  ?! " << "";
+}
+
+void TestAnswerCache::normalizesQuestion() {
+    QFETCH(QString, question);
+    QFETCH(QString, normalized);
+    QCOMPARE(AnswerCache::normalizeQuestion(question), normalized);
+}
+
+void TestAnswerCache::keyIgnoresWording() {
+    const QVariantMap context = pageContext("https://example.com/a");
+    const QByteArray key = AnswerCache::keyFor("What is the GDP of France?", context, "m");
+    QCOMPARE(key.size(), qsizetype(40)); // hex SHA-1
+    QCOMPARE(AnswerCache::keyFor("  what is the gdp of france ", context, "m"), key);
+    QCOMPARE(AnswerCache::keyFor("Tell me about statistics related to EVs", context, "m"),
+             AnswerCache::keyFor("search for statistics about evs", context, "m"));
+}
+
+void TestAnswerCache::keySeparatesContext() {
+    const QString q = QStringLiteral("gdp of france");
+    const QByteArray key = AnswerCache::keyFor(q, pageContext("https://example.com/a"), "m");
+
+    QVERIFY(AnswerCache::keyFor(q, pageContext("https://example.com/b"), "m") != key);
+    QVERIFY(AnswerCache::keyFor(q, pageContext("https://example.com/a"), "other") != key);
+
+    QVariantMap withSelection = pageContext("https://example.com/a");
+    withSelection["selection"] = QStringLiteral("  2021 figures ");
+    const QByteArray selected = AnswerCache::keyFor(q, withSelection, "m");
+    QVERIFY(selected != key);
+    withSelection["selection"] = QStringLiteral("2021 figures");
+    QCOMPARE(AnswerCache::keyFor(q, withSelection, "m"), selected);
+}
+
+void TestAnswerCache::keyHashesPageTextWithoutUrl() {
+    const QString q = QStringLiteral("summarize");
+    const QByteArray a = AnswerCache::keyFor(q, pageContext(QString(), "page one"), "m");
+    QVERIFY(AnswerCache::keyFor(q, pageContext(QString(), "page two"), "m") != a);
+    QCOMPARE(AnswerCache::keyFor(q, pageContext(QString(), "page one"), "m"), a);
+
+    // With a URL the page text does not take part
+    QCOMPARE(AnswerCache::keyFor(q, pageContext("https://example.com", "page one"), "m"),
+             AnswerCache::keyFor(q, pageContext("https://example.com", "page two"), "m"));
+}
+
+void TestAnswerCache::keySeparatesThreads() {
+    const QVariantMap context = pageContext("https://example.com");
+    const QByteArray first = AnswerCache::keyFor("and in 2020?", context, "m");
+    QCOMPARE(AnswerCache::keyFor("and in 2020?", context, "m", QByteArray()), first);
+
+    const QByteArray threadA = AnswerCache::keyFor("and in 2020?", context, "m", "thread-a");
+    const QByteArray threadB = AnswerCache::keyFor("and in 2020?", context, "m", "thread-b");
+    QVERIFY(threadA != first);
+    QVERIFY(threadA != threadB);
+}
+
+void TestAnswerCache::storesAndLooksUp() {
+    QTemporaryDir dir;
+    AnswerCache cache(dir.filePath("answers.bin"), 1);
+    QVERIFY(cache.isEnabled());
+    QVERIFY(!cache.isDirty());
+
+    AnswerCache::Entry out;
+    QVERIFY(!cache.lookup("k", &out));
+    cache.store("k", entry("answer", 0));
+    QVERIFY(cache.isDirty());
+    QVERIFY(cache.lookup("k", &out));
+    QCOMPARE(out.text, QStringLiteral("answer"));
+    QVERIFY(out.storedAt > 0); // stamped on store
+
+    // Stored too long ago to be served
+    cache.store("old", entry("stale", QDateTime::currentMSecsSinceEpoch() - 2 * kHourMs));
+    QVERIFY(!cache.lookup("old", &out));
+}
+
+void TestAnswerCache::skipsEmptyAnswersAndDisabledCache() {
+    QTemporaryDir dir;
+    AnswerCache cache(dir.filePath("answers.bin"), 1);
+    cache.store("k", entry(" \n", 0));
+    AnswerCache::Entry out;
+    QVERIFY(!cache.lookup("k", &out));
+    QVERIFY(!cache.isDirty());
+
+    AnswerCache disabled(dir.filePath("disabled.bin"), 0);
+    QVERIFY(!disabled.isEnabled());
+    disabled.store("k", entry("answer", 0));
+    QVERIFY(!disabled.lookup("k", &out));
+    QVERIFY(!disabled.load());
+}
+
+void TestAnswerCache::evictsOldestPastCap() {
+    QTemporaryDir dir;
+    AnswerCache cache(dir.filePath("answers.bin"), 1, 2);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    cache.store("a", entry("1", now - 3000));
+    cache.store("b", entry("2", now - 2000));
+    cache.store("c", entry("3", now - 1000));
+
+    AnswerCache::Entry out;
+    QVERIFY(!cache.lookup("a", &out));
+    QVERIFY(cache.lookup("b", &out));
+    QVERIFY(cache.lookup("c", &out));
+}
+
+void TestAnswerCache::roundTripsThroughFile() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("nested/answers.bin");
+    AnswerCache::Entry e = entry("answer", QDateTime::currentMSecsSinceEpoch());
+    e.citations = {QVariantMap{{"title", "Source"}, {"link", "https://example.com/s"}}};
+    {
+        AnswerCache cache(path, 1);
+        cache.store("k", e);
+        QVERIFY(cache.save());
+        QVERIFY(!cache.isDirty());
+    }
+
+    AnswerCache cache(path, 1);
+    QVERIFY(cache.load());
+    QVERIFY(!cache.isDirty());
+    AnswerCache::Entry out;
+    QVERIFY(cache.lookup("k", &out));
+    QCOMPARE(out.text, e.text);
+    QCOMPARE(out.model, e.model);
+    QCOMPARE(out.storedAt, e.storedAt);
+    QCOMPARE(out.citations, e.citations);
+}
+
+void TestAnswerCache::prunesExpiredOnLoad() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("answers.bin");
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    {
+        // Written with a longer TTL, so the old entry is still in the file
+        AnswerCache cache(path, 24);
+        cache.store("fresh", entry("new", now));
+        cache.store("expired", entry("old", now - 2 * kHourMs));
+        QVERIFY(cache.save());
+    }
+
+    AnswerCache cache(path, 1);
+    QVERIFY(cache.load());
+    AnswerCache::Entry out;
+    QVERIFY(cache.lookup("fresh", &out));
+    QVERIFY(!cache.lookup("expired", &out));
+    // The pruned file needs rewriting
+    QVERIFY(cache.isDirty());
+    QVERIFY(cache.approxBytes() > 0);
+}
+
+void TestAnswerCache::ignoresIncompatibleFile() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath("answers.bin");
+    QFile f(path);
+    QVERIFY(f.open(QIODevice::WriteOnly));
+    f.write("not an answer cache");
+    f.close();
+
+    AnswerCache cache(path, 1);
+    QVERIFY(!cache.load());
+    AnswerCache::Entry out;
+    QVERIFY(!cache.lookup("k", &out));
+}
+
+QTEST_APPLESS_MAIN(TestAnswerCache)
+#include "tst_answercache.moc"
@@ -0,0 +1,231 @@
+// ConversationJournal: paged reads, and recovery on open when the index lags
+// the log or the last write was torn.
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include "conversationjournal.h"
+
+namespace {
+QVariantMap message(const QString& content) {
+    return {{"role", "user"}, {"content", content}};
+}
+
+QStringList contents(const QVariantList& messages) {
+    QStringList out;
+    for (const auto& m : messages) out << m.toMap().value("content").toString();
+    return out;
+}
+
+qint64 fileSize(const QString& path) {
+    return QFileInfo(path).size();
+}
+}
+
+class TestConversationJournal : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void createsEmptyJournal();
+    void readsMessagePages();
+    void reopensFromIndex();
+    void reindexesMissingIndex();
+    void reindexesLaggingIndex();
+    void dropsTornTail();
+    void dropsTornRecordAtLastIndexedOffset_data();
+    void dropsTornRecordAtLastIndexedOffset();
+    void resetsIncompatibleJournal();
+    void clearRemovesFiles();
+
+private:
+    // Three messages with a tool call and citations in between
+    void writeConversation();
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_base;
+    QString m_log;
+    QString m_idx;
+};
+
+void TestConversationJournal::init() {
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_base = m_dir->filePath("threads/t1");
+    m_log = m_base + ".log";
+    m_idx = m_base + ".idx";
+}
+
+void TestConversationJournal::writeConversation() {
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QVERIFY(journal.appendMessage(message("m0")));
+    QVERIFY(journal.appendToolCall("search", R"({"query":"gdp"})"));
+    QVERIFY(journal.appendMessage(message("m1")));
+    QVERIFY(journal.appendCitations({QVariantMap{{"title", "Source"}}}));
+    QVERIFY(journal.appendMessage(message("m2")));
+    QCOMPARE(journal.messageCount(), 3);
+}
+
+void TestConversationJournal::createsEmptyJournal() {
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 0);
+    QCOMPARE(fileSize(m_log), qint64(8)); // header only
+    QVERIFY(journal.readMessages(0, 10).isEmpty());
+}
+
+void TestConversationJournal::readsMessagePages() {
+    writeConversation();
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+
+    QCOMPARE(contents(journal.readMessages(0, 3)), QStringList({"m0", "m1", "m2"}));
+    QCOMPARE(contents(journal.readMessages(1, 5)), QStringList({"m1", "m2"}));
+    QCOMPARE(contents(journal.readMessages(-1, 2)), QStringList({"m0", "m1"}));
+    QVERIFY(journal.readMessages(3, 1).isEmpty());
+    QVERIFY(journal.readMessages(0, 0).isEmpty());
+    QCOMPARE(journal.readMessages(2, 1).first().toMap(), message("m2"));
+}
+
+void TestConversationJournal::reopensFromIndex() {
+    writeConversation();
+    const qint64 logSize = fileSize(m_log);
+
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 3);
+    QCOMPARE(fileSize(m_idx), qint64(3 * sizeof(qint64)));
+    QCOMPARE(fileSize(m_log), logSize);
+
+    QVERIFY(journal.appendMessage(message("m3")));
+    QCOMPARE(contents(journal.readMessages(2, 2)), QStringList({"m2", "m3"}));
+}
+
+void TestConversationJournal::reindexesMissingIndex() {
+    writeConversation();
+    QVERIFY(QFile::remove(m_idx));
+
+    {
+        ConversationJournal journal(m_base);
+        QVERIFY(journal.open());
+        QCOMPARE(journal.messageCount(), 3);
+        QCOMPARE(contents(journal.readMessages(0, 3)), QStringList({"m0", "m1", "m2"}));
+    }
+    // The rebuilt index is used as is next time
+    QCOMPARE(fileSize(m_idx), qint64(3 * sizeof(qint64)));
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 3);
+    QCOMPARE(fileSize(m_idx), qint64(3 * sizeof(qint64)));
+}
+
+void TestConversationJournal::reindexesLaggingIndex() {
+    writeConversation();
+    QVERIFY(QFile::resize(m_idx, sizeof(qint64)));
+
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 3);
+    QCOMPARE(contents(journal.readMessages(0, 3)), QStringList({"m0", "m1", "m2"}));
+    QCOMPARE(fileSize(m_idx), qint64(3 * sizeof(qint64)));
+}
+
+void TestConversationJournal::dropsTornTail() {
+    writeConversation();
+    const qint64 logSize = fileSize(m_log);
+    {
+        // A message record whose payload never made it to disk
+        QFile f(m_log);
+        QVERIFY(f.open(QIODevice::Append));
+        QDataStream out(&f);
+        out << quint8(1) << quint32(1000);
+        out.writeRawData("abc", 3);
+    }
+
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 3);
+    QCOMPARE(fileSize(m_log), logSize);
+
+    QVERIFY(journal.appendMessage(message("m3")));
+    ConversationJournal reopened(m_base);
+    QVERIFY(reopened.open());
+    QCOMPARE(contents(reopened.readMessages(0, 4)), QStringList({"m0", "m1", "m2", "m3"}));
+}
+
+void TestConversationJournal::dropsTornRecordAtLastIndexedOffset_data() {
+    QTest::addColumn<int>("keptBytes");
+
+    QTest::newRow("nothing") << 0;
+    QTest::newRow("type only") << 1;
+    QTest::newRow("partial length") << 3;
+    QTest::newRow("record header") << 5;
+    QTest::newRow("partial payload") << 9;
+}
+
+void TestConversationJournal::dropsTornRecordAtLastIndexedOffset() {
+    QFETCH(int, keptBytes);
+
+    qint64 lastOffset = 0;
+    {
+        ConversationJournal journal(m_base);
+        QVERIFY(journal.open());
+        QVERIFY(journal.appendMessage(message("m0")));
+        lastOffset = fileSize(m_log);
+        QVERIFY(journal.appendMessage(message("m1")));
+    }
+    // The index already points at m1, but only part of it reached the log
+    QCOMPARE(fileSize(m_idx), qint64(2 * sizeof(qint64)));
+    QVERIFY(QFile::resize(m_log, lastOffset + keptBytes));
+
+    {
+        ConversationJournal journal(m_base);
+        QVERIFY(journal.open());
+        QCOMPARE(journal.messageCount(), 1);
+        QCOMPARE(fileSize(m_log), lastOffset);
+        QCOMPARE(fileSize(m_idx), qint64(sizeof(qint64)));
+        QCOMPARE(contents(journal.readMessages(0, 2)), QStringList({"m0"}));
+        QVERIFY(journal.appendMessage(message("m2")));
+    }
+
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(contents(journal.readMessages(0, 2)), QStringList({"m0", "m2"}));
+}
+
+void TestConversationJournal::resetsIncompatibleJournal() {
+    writeConversation();
+    {
+        QFile f(m_log);
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        f.write("not a journal");
+    }
+
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.messageCount(), 0);
+    QCOMPARE(fileSize(m_log), qint64(8));
+    QVERIFY(!QFile::exists(m_idx));
+}
+
+void TestConversationJournal::clearRemovesFiles() {
+    writeConversation();
+    ConversationJournal journal(m_base);
+    QVERIFY(journal.open());
+    journal.clear();
+    QCOMPARE(journal.messageCount(), 0);
+    QVERIFY(!QFile::exists(m_log));
+    QVERIFY(!QFile::exists(m_idx));
+
+    // Opening again starts a fresh journal
+    QVERIFY(journal.open());
+    QVERIFY(journal.appendMessage(message("m0")));
+    QCOMPARE(journal.messageCount(), 1);
+}
+
+QTEST_APPLESS_MAIN(TestConversationJournal)
+#include "tst_conversationjournal.moc"
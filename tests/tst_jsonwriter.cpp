@@ -0,0 +1,179 @@
+// JsonWriter: compact output, comma placement across nesting, raw() splicing
+// and string escaping.
+
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "jsonwriter.h"
+
+class TestJsonWriter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void writesCompactObject();
+    void writesEmptyContainers();
+    void separatesTopLevelValues();
+    void extendsEncodedList();
+    void splicesRawFragments();
+    void skipsEmptyRaw();
+    void escapesStrings_data();
+    void escapesStrings();
+    void roundTripsStrings();
+    void writesShortestDoubles();
+};
+
+void TestJsonWriter::writesCompactObject() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginObject();
+    w.key("model");
+    w.value("m");
+    w.key("max_tokens");
+    w.value(1024);
+    w.key("stream");
+    w.value(true);
+    w.key("messages");
+    w.beginArray();
+    w.beginObject();
+    w.key("role");
+    w.value(QStringLiteral("user"));
+    w.key("content");
+    w.value(QStringLiteral("hi"));
+    w.endObject();
+    w.endArray();
+    w.endObject();
+
+    QCOMPARE(out, QByteArray(R"({"model":"m","max_tokens":1024,"stream":true,)"
+                             R"("messages":[{"role":"user","content":"hi"}]})"));
+}
+
+void TestJsonWriter::writesEmptyContainers() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginObject();
+    w.key("a");
+    w.beginArray();
+    w.endArray();
+    w.key("b");
+    w.beginObject();
+    w.endObject();
+    w.key("c");
+    w.value(false);
+    w.endObject();
+
+    QCOMPARE(out, QByteArray(R"({"a":[],"b":{},"c":false})"));
+}
+
+void TestJsonWriter::separatesTopLevelValues() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.value(1);
+    w.value("x");
+    w.beginObject();
+    w.endObject();
+
+    QCOMPARE(out, QByteArray(R"(1,"x",{})"));
+}
+
+void TestJsonWriter::extendsEncodedList() {
+    // A writer over already encoded array elements continues the list
+    QByteArray out(R"({"a":1})");
+    JsonWriter w(&out);
+    w.beginObject();
+    w.key("b");
+    w.value(2);
+    w.endObject();
+
+    QCOMPARE(out, QByteArray(R"({"a":1},{"b":2})"));
+    const QJsonArray list = QJsonDocument::fromJson("[" + out + "]").array();
+    QCOMPARE(list.size(), qsizetype(2));
+    QCOMPARE(list.at(1).toObject().value("b").toInt(), 2);
+}
+
+void TestJsonWriter::splicesRawFragments() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginObject();
+    w.key("system");
+    w.raw(R"([{"type":"text","text":"s"}])");
+    w.key("messages");
+    w.beginArray();
+    w.value(0);
+    w.raw("1,2"); // comma-joined elements
+    w.value(3);
+    w.endArray();
+    w.endObject();
+
+    QCOMPARE(out, QByteArray(R"({"system":[{"type":"text","text":"s"}],"messages":[0,1,2,3]})"));
+}
+
+void TestJsonWriter::skipsEmptyRaw() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginArray();
+    w.raw(QByteArray());
+    w.value(1);
+    w.raw(QByteArray());
+    w.value(2);
+    w.endArray();
+
+    QCOMPARE(out, QByteArray("[1,2]"));
+}
+
+void TestJsonWriter::escapesStrings_data() {
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::newRow("plain") << QStringLiteral("abc") << QByteArray(R"("abc")");
+    QTest::newRow("empty") << QString() << QByteArray(R"("")");
+    QTest::newRow("quote and backslash") << QStringLiteral("a\"b\\c") << QByteArray(R"("a\"b\\c")");
+    QTest::newRow("short escapes") << QStringLiteral("\n\r\t\b\f") << QByteArray(R"("\n\r\t\b\f")");
+    QTest::newRow("control") << QString(QChar(0x01)) + QChar(0x1f) << QByteArray(R"("\u0001\u001f")");
+    QTest::newRow("slash kept") << QStringLiteral("a/b") << QByteArray(R"("a/b")");
+    QTest::newRow("utf-8") << QStringLiteral("café €") << QByteArray("\"caf\xc3\xa9 \xe2\x82\xac\"");
+}
+
+void TestJsonWriter::escapesStrings() {
+    QFETCH(QString, input);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(JsonWriter::encodeString(input), expected);
+
+    QByteArray out("x");
+    JsonWriter::appendString(out, input);
+    QCOMPARE(out, "x" + expected);
+}
+
+void TestJsonWriter::roundTripsStrings() {
+    QString s;
+    for (ushort c = 1; c < 0x80; ++c) s.append(QChar(c));
+    s += QStringLiteral("é中\U0001F600");
+
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginArray();
+    w.value(s);
+    w.endArray();
+
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(out, &err);
+    QCOMPARE(err.error, QJsonParseError::NoError);
+    QCOMPARE(doc.array().at(0).toString(), s);
+}
+
+void TestJsonWriter::writesShortestDoubles() {
+    QByteArray out;
+    JsonWriter w(&out);
+    w.beginArray();
+    w.value(0.1);
+    w.value(2.5);
+    w.value(100.0);
+    w.value(-3);
+    w.endArray();
+
+    QCOMPARE(out, QByteArray("[0.1,2.5,100,-3]"));
+}
+
+QTEST_APPLESS_MAIN(TestJsonWriter)
+#include "tst_jsonwriter.moc"
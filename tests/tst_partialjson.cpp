@@ -0,0 +1,162 @@
+// PartialJsonObject: members are reported once their value is complete, never
+// early or wrong, wherever the fragment boundaries fall.
+
+#include <QtTest>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include "partialjson.h"
+
+namespace {
+const QString kMixed = QStringLiteral(
+    R"({ "query" : "a \"quoted\" {brace}, [bracket]: colon","n":-12.5e1,"ok":false,"none":null,)"
+    R"("nested":{"k":["x\\","]"],"e":{}},"u":"\u00e9\n","a\"b":1,"last":42})");
+}
+
+class TestPartialJson : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesFullParse_data();
+    void matchesFullParse();
+    void reportsStringOnClosingQuote();
+    void waitsForNumberTerminator();
+    void finishesValueAtDepthZero_data();
+    void finishesValueAtDepthZero();
+    void handlesEscapeAcrossFragments();
+    void endsStringAfterEscapedBackslash();
+    void ignoresTextAfterClose();
+    void reportsEmptyObject();
+    void hasAllRequiresEveryKey();
+    void resetStartsOver();
+};
+
+void TestPartialJson::matchesFullParse_data() {
+    QTest::addColumn<int>("chunkSize");
+    for (int size : {1, 2, 3, 5, 7, 16, 1000}) QTest::newRow(qPrintable(QString::number(size))) << size;
+}
+
+void TestPartialJson::matchesFullParse() {
+    QFETCH(int, chunkSize);
+    const QJsonObject expected = QJsonDocument::fromJson(kMixed.toUtf8()).object();
+    QVERIFY(!expected.isEmpty());
+
+    PartialJsonObject p;
+    for (qsizetype i = 0; i < kMixed.size(); i += chunkSize) {
+        p.feed(kMixed.mid(i, chunkSize));
+        // Whatever has been reported so far is already final
+        const QJsonObject& seen = p.members();
+        for (auto it = seen.begin(); it != seen.end(); ++it) {
+            QVERIFY2(expected.contains(it.key()), qPrintable(it.key()));
+            QCOMPARE(it.value(), expected.value(it.key()));
+        }
+        QCOMPARE(p.isClosed(), i + chunkSize >= kMixed.size());
+    }
+    QCOMPARE(p.members(), expected);
+}
+
+void TestPartialJson::reportsStringOnClosingQuote() {
+    PartialJsonObject p;
+    p.feed(R"({"query":"gdp of fra)");
+    QVERIFY(!p.members().contains("query"));
+    p.feed("nce");
+    QVERIFY(!p.members().contains("query"));
+    p.feed("\"");
+    // No need to wait for the following ',' or '}'
+    QCOMPARE(p.members().value("query").toString(), QStringLiteral("gdp of france"));
+    QVERIFY(!p.isClosed());
+}
+
+void TestPartialJson::waitsForNumberTerminator() {
+    PartialJsonObject p;
+    p.feed(R"({"limit":12)");
+    QVERIFY(!p.members().contains("limit"));
+    p.feed("3");
+    QVERIFY(!p.members().contains("limit"));
+    p.feed(R"(,"x":)");
+    QCOMPARE(p.members().value("limit").toInt(), 123);
+    QVERIFY(!p.members().contains("x"));
+}
+
+void TestPartialJson::finishesValueAtDepthZero_data() {
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QJsonValue>("value");
+
+    QTest::newRow("number") << QStringLiteral(R"({"v":5})") << QJsonValue(5);
+    QTest::newRow("number with space") << QStringLiteral(R"({"v": 5 })") << QJsonValue(5);
+    QTest::newRow("true") << QStringLiteral(R"({"v":true})") << QJsonValue(true);
+    QTest::newRow("null") << QStringLiteral(R"({"v":null})") << QJsonValue(QJsonValue::Null);
+    QTest::newRow("string") << QStringLiteral(R"({"v":"s"})") << QJsonValue(QStringLiteral("s"));
+    QTest::newRow("array") << QStringLiteral(R"({"v":[1]})") << QJsonValue(QJsonArray{1});
+}
+
+void TestPartialJson::finishesValueAtDepthZero() {
+    QFETCH(QString, text);
+    QFETCH(QJsonValue, value);
+
+    PartialJsonObject p;
+    p.feed(text.chopped(1));
+    p.feed(text.right(1));
+    QVERIFY(p.isClosed());
+    QCOMPARE(p.members().size(), qsizetype(1));
+    QCOMPARE(p.members().value("v"), value);
+}
+
+void TestPartialJson::handlesEscapeAcrossFragments() {
+    PartialJsonObject p;
+    p.feed(R"({"q":"x\)");
+    p.feed(R"("y",)");
+    QCOMPARE(p.members().value("q").toString(), QStringLiteral("x\"y"));
+
+    // The escape in a key is split the same way
+    p.feed(R"("k\)");
+    p.feed(R"(u0041":1})");
+    QCOMPARE(p.members().value("kA").toInt(), 1);
+    QVERIFY(p.isClosed());
+}
+
+void TestPartialJson::endsStringAfterEscapedBackslash() {
+    PartialJsonObject p;
+    p.feed(R"({"path":"C:\\)");
+    QVERIFY(!p.members().contains("path"));
+    p.feed(R"(")");
+    QCOMPARE(p.members().value("path").toString(), QStringLiteral("C:\\"));
+}
+
+void TestPartialJson::ignoresTextAfterClose() {
+    PartialJsonObject p;
+    p.feed(R"({"a":1} {"b":2})");
+    QVERIFY(p.isClosed());
+    p.feed(R"(,"c":3})");
+    QCOMPARE(p.members(), QJsonObject({{"a", 1}}));
+}
+
+void TestPartialJson::reportsEmptyObject() {
+    PartialJsonObject p;
+    p.feed("{");
+    QVERIFY(!p.isClosed());
+    p.feed("}");
+    QVERIFY(p.isClosed());
+    QVERIFY(p.members().isEmpty());
+}
+
+void TestPartialJson::hasAllRequiresEveryKey() {
+    PartialJsonObject p;
+    p.feed(R"({"query":"q","limit":)");
+    QVERIFY(p.hasAll({"query"}));
+    QVERIFY(!p.hasAll({"query", "limit"}));
+    p.feed("3}");
+    QVERIFY(p.hasAll({"query", "limit"}));
+    QVERIFY(p.hasAll({}));
+}
+
+void TestPartialJson::resetStartsOver() {
+    PartialJsonObject p;
+    p.feed(R"({"a":"unfinished)");
+    p.reset();
+    p.feed(R"({"b":2})");
+    QVERIFY(p.isClosed());
+    QCOMPARE(p.members(), QJsonObject({{"b", 2}}));
+}
+
+QTEST_APPLESS_MAIN(TestPartialJson)
+#include "tst_partialjson.moc"